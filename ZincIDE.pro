@@ -0,0 +1,6 @@
+# Builds the IDE and its benchmarks. The IDE can still be built on its own
+# from ZincIDE/ZincIDE.pro.
+
+TEMPLATE = subdirs
+
+SUBDIRS = ZincIDE benchmarks
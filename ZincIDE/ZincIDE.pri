@@ -0,0 +1,102 @@
+# Sources of the IDE shared by the application and the benchmarks
+
+QT       += core gui webkitwidgets printsupport
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+# rtfexporter.h registers its pasteboard converter through QMacPasteboardMime
+macx: QT += macextras
+
+VERSION = 0.9.8
+DEFINES += MINIZINC_IDE_VERSION=\\\"$$VERSION\\\"
+
+bundled {
+    DEFINES += MINIZINC_IDE_BUNDLED
+}
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/mainwindow.cpp \
+    $$PWD/codeeditor.cpp \
+    $$PWD/highlighter.cpp \
+    $$PWD/fzndoc.cpp \
+    $$PWD/aboutdialog.cpp \
+    $$PWD/solverdialog.cpp \
+    $$PWD/gotolinedialog.cpp \
+    $$PWD/help.cpp \
+    $$PWD/finddialog.cpp \
+    $$PWD/paramdialog.cpp \
+    $$PWD/outputdockwidget.cpp \
+    $$PWD/checkupdatedialog.cpp \
+    $$PWD/project.cpp \
+    $$PWD/htmlwindow.cpp \
+    $$PWD/htmlpage.cpp \
+    $$PWD/courserasubmission.cpp \
+    $$PWD/rtfexporter.cpp \
+    $$PWD/processmonitor.cpp \
+    $$PWD/outputconsole.cpp \
+    $$PWD/solutionstore.cpp \
+    $$PWD/convergencechart.cpp \
+    $$PWD/tokenizer.cpp \
+    $$PWD/documentexporter.cpp \
+    $$PWD/indentengine.cpp \
+    $$PWD/backgroundchecker.cpp \
+    $$PWD/modelfingerprint.cpp \
+    $$PWD/diagnosticparser.cpp \
+    $$PWD/problemspanel.cpp \
+    $$PWD/libraryindex.cpp \
+    $$PWD/librarybrowser.cpp \
+    $$PWD/completionindex.cpp \
+    $$PWD/editjournal.cpp \
+    $$PWD/settings.cpp \
+    $$PWD/trace.cpp
+
+HEADERS  += $$PWD/mainwindow.h \
+    $$PWD/codeeditor.h \
+    $$PWD/highlighter.h \
+    $$PWD/fzndoc.h \
+    $$PWD/aboutdialog.h \
+    $$PWD/solverdialog.h \
+    $$PWD/gotolinedialog.h \
+    $$PWD/help.h \
+    $$PWD/finddialog.h \
+    $$PWD/paramdialog.h \
+    $$PWD/outputdockwidget.h \
+    $$PWD/checkupdatedialog.h \
+    $$PWD/project.h \
+    $$PWD/rtfexporter.h \
+    $$PWD/htmlwindow.h \
+    $$PWD/htmlpage.h \
+    $$PWD/courserasubmission.h \
+    $$PWD/processmonitor.h \
+    $$PWD/outputconsole.h \
+    $$PWD/solutionstore.h \
+    $$PWD/convergencechart.h \
+    $$PWD/tokenizer.h \
+    $$PWD/documentexporter.h \
+    $$PWD/indentengine.h \
+    $$PWD/backgroundchecker.h \
+    $$PWD/modelfingerprint.h \
+    $$PWD/diagnosticparser.h \
+    $$PWD/problemspanel.h \
+    $$PWD/libraryindex.h \
+    $$PWD/librarybrowser.h \
+    $$PWD/completionindex.h \
+    $$PWD/editjournal.h \
+    $$PWD/settings.h \
+    $$PWD/trace.h
+
+FORMS    += \
+    $$PWD/mainwindow.ui \
+    $$PWD/aboutdialog.ui \
+    $$PWD/solverdialog.ui \
+    $$PWD/gotolinedialog.ui \
+    $$PWD/help.ui \
+    $$PWD/finddialog.ui \
+    $$PWD/paramdialog.ui \
+    $$PWD/checkupdatedialog.ui \
+    $$PWD/htmlwindow.ui \
+    $$PWD/courserasubmission.ui
+
+RESOURCES += \
+    $$PWD/minizincide.qrc
@@ -4,25 +4,13 @@
 #
 #-------------------------------------------------
 
-QT       += core gui webkitwidgets
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
 TARGET = ZincIDE
 TEMPLATE = app
 
-VERSION = 0.9.8
-DEFINES += MINIZINC_IDE_VERSION=\\\"$$VERSION\\\"
-
-bundled {
-    DEFINES += MINIZINC_IDE_BUNDLED
-}
+include(ZincIDE.pri)
 
 macx {
     ICON = mznide.icns
-    OBJECTIVE_SOURCES += rtfexporter.mm
-    QT += macextras
-    LIBS += -framework Cocoa
 }
 
 macx:bundled {
@@ -36,53 +24,4 @@ RC_ICONS = mznide.ico
 
 CONFIG += embed_manifest_exe
 
-SOURCES += main.cpp\
-        mainwindow.cpp \
-    codeeditor.cpp \
-    highlighter.cpp \
-    fzndoc.cpp \
-    aboutdialog.cpp \
-    solverdialog.cpp \
-    gotolinedialog.cpp \
-    help.cpp \
-    finddialog.cpp \
-    paramdialog.cpp \
-    outputdockwidget.cpp \
-    checkupdatedialog.cpp \
-    project.cpp \
-    htmlwindow.cpp \
-    htmlpage.cpp \
-    courserasubmission.cpp
-
-HEADERS  += mainwindow.h \
-    codeeditor.h \
-    highlighter.h \
-    fzndoc.h \
-    aboutdialog.h \
-    solverdialog.h \
-    gotolinedialog.h \
-    help.h \
-    finddialog.h \
-    paramdialog.h \
-    outputdockwidget.h \
-    checkupdatedialog.h \
-    project.h \
-    rtfexporter.h \
-    htmlwindow.h \
-    htmlpage.h \
-    courserasubmission.h
-
-FORMS    += \
-    mainwindow.ui \
-    aboutdialog.ui \
-    solverdialog.ui \
-    gotolinedialog.ui \
-    help.ui \
-    finddialog.ui \
-    paramdialog.ui \
-    checkupdatedialog.ui \
-    htmlwindow.ui \
-    courserasubmission.ui
-
-RESOURCES += \
-    minizincide.qrc
+SOURCES += main.cpp
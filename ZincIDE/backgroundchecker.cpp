@@ -0,0 +1,275 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "backgroundchecker.h"
+#include "diagnosticparser.h"
+#include "solverdialog.h"
+#include "tokenizer.h"
+#include "trace.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+
+static const int maxCachedResults = 32;
+
+BackgroundChecker::BackgroundChecker(QObject *parent)
+    : QObject(parent), _process(NULL), _enabled(true)
+{
+    _pause.setSingleShot(true);
+    _pause.setInterval(800);
+    connect(&_pause, SIGNAL(timeout()), this, SLOT(startCheck()));
+}
+
+BackgroundChecker::~BackgroundChecker(void)
+{
+    cancel();
+}
+
+void BackgroundChecker::setCompiler(const QString& executable, const QString& path, const QStringList& args)
+{
+    if (executable==_executable && path==_path && args==_args)
+        return;
+    _executable = executable;
+    _path = path;
+    _args = args;
+    // The diagnostics shown were produced with the old settings
+    cancel();
+    if (_enabled && _editor)
+        _pause.start();
+}
+
+void BackgroundChecker::setEditor(CodeEditor* editor)
+{
+    if (_editor)
+        disconnect(_editor, SIGNAL(textChanged()), this, SLOT(textChanged()));
+    cancel();
+    _pause.stop();
+    _editor = editor;
+    if (_editor) {
+        connect(_editor, SIGNAL(textChanged()), this, SLOT(textChanged()));
+        if (_enabled)
+            _pause.start();
+    }
+}
+
+void BackgroundChecker::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+    if (_enabled) {
+        if (_editor)
+            _pause.start();
+    } else {
+        cancel();
+        _pause.stop();
+        apply(Result());
+    }
+}
+
+void BackgroundChecker::textChanged(void)
+{
+    // Whatever is running now is checking an outdated version
+    cancel();
+    if (_enabled)
+        _pause.start();
+}
+
+void BackgroundChecker::cancel(void)
+{
+    if (_process) {
+        disconnect(_process, 0, this, 0);
+        connect(_process, SIGNAL(finished(int)), _process, SLOT(deleteLater()));
+        _process->killGroup();
+        _process = NULL;
+    }
+    if (!_snapshotFile.isEmpty()) {
+        QFile::remove(_snapshotFile);
+        _snapshotFile.clear();
+    }
+}
+
+void BackgroundChecker::startCheck(void)
+{
+    if (!_editor || !_enabled || _executable.isEmpty() || _process)
+        return;
+    if (QFileInfo(_editor->filename).completeSuffix() != "zinc")
+        return;
+    _text = _editor->document()->toPlainText();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(_editor->filepath.toUtf8());
+    hash.addData(_args.join("\n").toUtf8());
+    hash.addData(_text.toUtf8());
+    _hash = hash.result();
+    if (_cache.contains(_hash)) {
+        apply(_cache[_hash]);
+        return;
+    }
+
+    // A saved model is checked directly. Otherwise a snapshot is written
+    // to the temporary directory, and included files are searched for in
+    // the directory of the model.
+    QString dir;
+    QStringList includes;
+    if (_editor->filepath.isEmpty()) {
+        if (!_tmpDir.isValid())
+            return;
+        dir = _tmpDir.path();
+        _checkedFile = dir+"/"+_editor->filename;
+        _snapshotFile = _checkedFile;
+    } else {
+        QFileInfo fi(_editor->filepath);
+        dir = fi.absolutePath();
+        if (_editor->document()->isModified()) {
+            if (!_tmpDir.isValid())
+                return;
+            _checkedFile = _tmpDir.path()+"/"+fi.fileName();
+            _snapshotFile = _checkedFile;
+            includes << "-I" << dir;
+        } else {
+            _checkedFile = fi.absoluteFilePath();
+        }
+    }
+    if (!_snapshotFile.isEmpty()) {
+        QFile f(_snapshotFile);
+        if (!f.open(QFile::WriteOnly | QFile::Truncate)) {
+            _snapshotFile.clear();
+            return;
+        }
+        f.write(_text.toUtf8());
+    }
+
+    _process = new MznProcess(this);
+    _process->setWorkingDirectory(dir);
+    _process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(_process, SIGNAL(finished(int)), this, SLOT(checkFinished(int)));
+    connect(_process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(checkError(QProcess::ProcessError)));
+    QStringList args = _args;
+    args << includes << "--instance-check-only" << "--output-to-stdout" << _checkedFile;
+    _process->start(_executable, args, _path);
+}
+
+void BackgroundChecker::checkError(QProcess::ProcessError e)
+{
+    // A process that failed to start never emits finished()
+    if (e == QProcess::FailedToStart) {
+        _process->deleteLater();
+        _process = NULL;
+        cancel();
+    }
+}
+
+void BackgroundChecker::checkFinished(int)
+{
+    TRACE_SPAN("BackgroundChecker::checkFinished");
+    QString output = QString::fromUtf8(_process->readAll());
+    _process->deleteLater();
+    _process = NULL;
+    if (!_snapshotFile.isEmpty()) {
+        QFile::remove(_snapshotFile);
+        _snapshotFile.clear();
+    }
+
+    Result r;
+    r.types = declarations(_text);
+    QString checked = QFileInfo(_checkedFile).fileName();
+    QStringList lines = output.split('\n');
+    bool inMessage = false;
+    for (int i=0; i<lines.size(); i++) {
+        DiagnosticParser::Diagnostic d;
+        if (DiagnosticParser::parse(lines[i], d)) {
+            // Errors in included files are only reported when running
+            inMessage = QFileInfo(d.file).fileName()==checked;
+            if (inMessage) {
+                r.diagnostics.append(CodeEditor::Diagnostic(d.line-1, std::max(0, d.col-1), d.message,
+                                                            d.severity != DiagnosticParser::Error));
+            }
+        } else if (inMessage && !lines[i].trimmed().isEmpty()) {
+            QString& m = r.diagnostics.last().message;
+            if (!m.isEmpty())
+                m += "\n";
+            m += lines[i].trimmed();
+        }
+    }
+    // Missing parameters are only asked for when running the model
+    for (int i=r.diagnostics.size(); i--;) {
+        if (r.diagnostics[i].message.contains("must be defined"))
+            r.diagnostics.remove(i);
+    }
+    if (_cache.size() >= maxCachedResults)
+        _cache.clear();
+    _cache.insert(_hash, r);
+    apply(r);
+}
+
+void BackgroundChecker::apply(const Result& r)
+{
+    if (_editor) {
+        _editor->setDiagnostics(r.diagnostics);
+        _editor->setTypes(r.types);
+    }
+}
+
+QHash<QString,QString> BackgroundChecker::declarations(const QString& text)
+{
+    // Blank out comments and strings, so that only code is scanned
+    QString code = text;
+    QChar* c = code.data();
+    QVector<Tokenizer::Token> tokens;
+    bool inComment = false;
+    int start = 0;
+    while (start <= code.size()) {
+        int nl = code.indexOf('\n', start);
+        if (nl == -1)
+            nl = code.size();
+        tokens.clear();
+        inComment = Tokenizer::tokenize(code.mid(start, nl-start), inComment, tokens);
+        for (int i=0; i<tokens.size(); i++) {
+            if (tokens[i].cls==Tokenizer::String || tokens[i].cls==Tokenizer::Comment) {
+                for (int j=0; j<tokens[i].length; j++)
+                    c[start+tokens[i].start+j] = ' ';
+            }
+        }
+        start = nl+1;
+    }
+
+    // A declaration is a type-inst, a colon and an identifier, where the
+    // type-inst extends back to the previous separator outside of brackets
+    QHash<QString,QString> types;
+    const int n = code.size();
+    for (int i=0; i<n; i++) {
+        if (c[i] != ':' || (i+1 < n && c[i+1]==':') || (i > 0 && c[i-1]==':'))
+            continue;
+        int idStart = i+1;
+        while (idStart < n && c[idStart].isSpace())
+            idStart++;
+        int idEnd = idStart;
+        while (idEnd < n && (c[idEnd].isLetterOrNumber() || c[idEnd]=='_'))
+            idEnd++;
+        if (idEnd==idStart || c[idStart].isDigit())
+            continue;
+        int depth = 0;
+        int typeStart = i;
+        while (typeStart > 0) {
+            QChar p = c[typeStart-1];
+            if (p==')' || p==']' || p=='}') {
+                depth++;
+            } else if (p=='(' || p=='[' || p=='{') {
+                if (depth==0)
+                    break;
+                depth--;
+            } else if (depth==0 && (p==';' || p==',')) {
+                break;
+            }
+            typeStart--;
+        }
+        QString type = code.mid(typeStart, i-typeStart).simplified();
+        QString name = code.mid(idStart, idEnd-idStart);
+        if (!type.isEmpty() && type.size() <= 200 && !types.contains(name))
+            types.insert(name, type);
+        i = idEnd-1;
+    }
+    return types;
+}
@@ -0,0 +1,67 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BACKGROUNDCHECKER_H
+#define BACKGROUNDCHECKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include "codeeditor.h"
+
+class MznProcess;
+
+/// Checks the model in an editor with the compiler front end whenever
+/// typing pauses, and shows the resulting diagnostics in the editor.
+///
+/// A check runs on a snapshot of the text. A check that is still running
+/// when the text changes again is cancelled. Results are cached by a hash
+/// of the text and the compiler arguments, so undoing back to a previous
+/// state does not run the compiler again.
+class BackgroundChecker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BackgroundChecker(QObject *parent = 0);
+    ~BackgroundChecker(void);
+    void setCompiler(const QString& executable, const QString& path, const QStringList& args);
+    /// Check the model in \a editor from now on (NULL to stop checking)
+    void setEditor(CodeEditor* editor);
+    bool isEnabled(void) const { return _enabled; }
+public slots:
+    void setEnabled(bool enabled);
+private slots:
+    void textChanged(void);
+    void startCheck(void);
+    void checkFinished(int exitcode);
+    void checkError(QProcess::ProcessError e);
+private:
+    struct Result {
+        QVector<CodeEditor::Diagnostic> diagnostics;
+        QHash<QString,QString> types;
+    };
+    QPointer<CodeEditor> _editor;
+    QTimer _pause;
+    MznProcess* _process;
+    QString _checkedFile;
+    QString _snapshotFile;
+    QByteArray _hash;
+    QString _text;
+    QTemporaryDir _tmpDir;
+    QHash<QByteArray,Result> _cache;
+    QString _executable;
+    QString _path;
+    QStringList _args;
+    bool _enabled;
+    void cancel(void);
+    void apply(const Result& r);
+    static QHash<QString,QString> declarations(const QString& text);
+};
+
+#endif // BACKGROUNDCHECKER_H
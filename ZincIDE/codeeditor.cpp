@@ -12,7 +12,11 @@
 
 #include <QtWidgets>
 #include "codeeditor.h"
+#include "trace.h"
 #include "mainwindow.h"
+#include "completionindex.h"
+
+#include <algorithm>
 
 void
 CodeEditor::initUI(QFont& font)
@@ -25,15 +29,25 @@ CodeEditor::initUI(QFont& font)
 
     connect(this, SIGNAL(blockCountChanged(int)), this, SLOT(setLineNumbersWidth(int)));
     connect(this, SIGNAL(updateRequest(QRect,int)), this, SLOT(setLineNumbers(QRect,int)));
+    connect(this, SIGNAL(updateRequest(QRect,int)), this, SLOT(refreshVisibleFormats()));
     connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(cursorChange()));
     connect(document(), SIGNAL(modificationChanged(bool)), this, SLOT(docChanged(bool)));
 
     setLineNumbersWidth(0);
     cursorChange();
 
-    highlighter = new Highlighter(font,darkMode,document());
+    highlighter = Highlighter::forDocument(document(), darkMode);
+    indentEngine = new IndentEngine(document(),this);
+    connect(highlighter, SIGNAL(longBlockHighlighted()), this, SLOT(longBlockFound()), Qt::QueuedConnection);
     setDarkMode(darkMode);
 
+    completer = new QCompleter(this);
+    completionModel = new QStringListModel(completer);
+    completer->setModel(completionModel);
+    completer->setWidget(this);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    connect(completer, SIGNAL(activated(QString)), this, SLOT(insertCompletion(QString)));
+
     QTextCursor cursor(textCursor());
     cursor.movePosition(QTextCursor::Start);
     setTextCursor(cursor);
@@ -43,8 +57,12 @@ CodeEditor::initUI(QFont& font)
 
 CodeEditor::CodeEditor(QTextDocument* doc, const QString& path, bool isNewFile, bool large,
                        QFont& font, bool darkMode0, QTabWidget* t, QWidget *parent) :
-    QPlainTextEdit(parent), loadContentsButton(NULL), tabs(t), darkMode(darkMode0)
+    QPlainTextEdit(parent), loadContentsButton(NULL), tabs(t), highlighter(NULL), darkMode(darkMode0),
+    columnSelecting(false), columnDragged(false), columnAnchorBlock(0), columnAnchorCol(0)
 {
+    hibernated = false;
+    hibernatedAnchor = hibernatedPosition = hibernatedScroll = hibernatedHScroll = 0;
+    lastViewed = QDateTime::currentMSecsSinceEpoch();
     if (doc) {
         QPlainTextEdit::setDocument(doc);
     }
@@ -80,23 +98,45 @@ void CodeEditor::loadedLargeFile()
 
 void CodeEditor::setDocument(QTextDocument *document)
 {
+    extraCursors.clear();
+    for (int i=0; i<NumDiagnosticSources; i++)
+        diagnostics[i].clear();
+    diagnosticSelections.clear();
     if (document) {
-        delete highlighter;
+        disconnect(QPlainTextEdit::document(), SIGNAL(modificationChanged(bool)), this, SLOT(docChanged(bool)));
+        // The highlighter belongs to the old document and stays with it
+        disconnect(highlighter, 0, this, 0);
         highlighter = NULL;
+        delete indentEngine;
+        indentEngine = NULL;
     }
     QPlainTextEdit::setDocument(document);
     if (document) {
-        QFont f= font();
-        highlighter = new Highlighter(f,document);
+        highlighter = Highlighter::forDocument(document, darkMode);
+        indentEngine = new IndentEngine(document,this);
+        connect(highlighter, SIGNAL(longBlockHighlighted()), this, SLOT(longBlockFound()), Qt::QueuedConnection);
         connect(document, SIGNAL(modificationChanged(bool)), this, SLOT(docChanged(bool)));
     }
 }
 
+void CodeEditor::longBlockFound()
+{
+    // Wrapping a line of several megabytes produces thousands of visual
+    // lines that have to be laid out again on every edit, so show long
+    // lines unwrapped with a horizontal scroll bar instead
+    if (lineWrapMode() != NoWrap)
+        setLineWrapMode(NoWrap);
+}
+
 void CodeEditor::setDarkMode(bool enable)
 {
     darkMode = enable;
-    highlighter->setDarkMode(enable);
-    highlighter->rehighlight();
+    // Other editors of the same document may already have switched it.
+    // Only the visible blocks get the new colours now, the others when
+    // they are scrolled into view or edited.
+    if (highlighter->isDarkMode() != enable)
+        highlighter->setDarkMode(enable);
+    refreshVisibleFormats();
     if (darkMode) {
         setStyleSheet("QPlainTextEdit{color: #ffffff; background-color: #181818;}");
     } else {
@@ -104,6 +144,21 @@ void CodeEditor::setDarkMode(bool enable)
     }
 }
 
+void CodeEditor::refreshVisibleFormats(void)
+{
+    if (highlighter==NULL)
+        return;
+    int bottom = viewport()->rect().bottom();
+    QPointF offset = contentOffset();
+    for (QTextBlock block = firstVisibleBlock(); block.isValid(); block = block.next()) {
+        if (!block.isVisible())
+            continue;
+        if (blockBoundingGeometry(block).translated(offset).top() > bottom)
+            break;
+        highlighter->refreshFormats(block);
+    }
+}
+
 void CodeEditor::docChanged(bool c)
 {
     int t = tabs == NULL ? -1 : tabs->indexOf(this);
@@ -118,15 +173,162 @@ void CodeEditor::docChanged(bool c)
 
 void CodeEditor::keyPressEvent(QKeyEvent *e)
 {
+    if (completer->popup()->isVisible()) {
+        switch (e->key()) {
+        case Qt::Key_Enter:
+        case Qt::Key_Return:
+        case Qt::Key_Escape:
+        case Qt::Key_Tab:
+        case Qt::Key_Backtab:
+            // Handled by the completer
+            e->ignore();
+            return;
+        default:
+            break;
+        }
+    }
+    if (e->key() == Qt::Key_Space && (e->modifiers() & Qt::ControlModifier)) {
+        e->accept();
+        updateCompletion(true);
+        return;
+    }
+    if ((e->modifiers() & Qt::AltModifier) && (e->modifiers() & Qt::ShiftModifier) &&
+            (e->key() == Qt::Key_Up || e->key() == Qt::Key_Down)) {
+        e->accept();
+        addCursorLine(e->key() == Qt::Key_Up);
+        return;
+    }
+    if (!extraCursors.isEmpty()) {
+        if (multiCursorKey(e)) {
+            e->accept();
+            return;
+        }
+        clearExtraCursors();
+    }
     if (e->key() == Qt::Key_Tab) {
         e->accept();
         QTextCursor cursor(textCursor());
         cursor.insertText("  ");
+    } else if ((e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) &&
+               !(e->modifiers() & (Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier))) {
+        e->accept();
+        // Insert the line break on its own, so that the new line has been
+        // highlighted (and its brackets are known) when it is indented
+        QTextCursor cursor(textCursor());
+        cursor.beginEditBlock();
+        cursor.insertBlock();
+        cursor.endEditBlock();
+        cursor.joinPreviousEditBlock();
+        indentLine(cursor);
+        cursor.endEditBlock();
+        setTextCursor(cursor);
+        ensureCursorVisible();
     } else {
         QPlainTextEdit::keyPressEvent(e);
+        QString t = e->text();
+        if (!t.isEmpty()) {
+            // Re-indent when a line starts with a closing bracket or keyword
+            // that outdents it
+            QTextCursor cursor(textCursor());
+            QString before = cursor.block().text().left(cursor.positionInBlock()).trimmed();
+            if (before.endsWith(t) &&
+                    (before==")" || before=="]" || before=="}" || before=="then" ||
+                     before=="else" || before=="elseif" || before=="endif")) {
+                cursor.joinPreviousEditBlock();
+                indentLine(cursor);
+                cursor.endEditBlock();
+                setTextCursor(cursor);
+            }
+            updateCompletion(false);
+        }
     }
 }
 
+void CodeEditor::updateCompletion(bool force)
+{
+    static const int maxCompletions = 50;
+    QTextCursor cursor(textCursor());
+    QString t = cursor.block().text();
+    int end = cursor.positionInBlock();
+    int start = end;
+    while (start > 0 && Tokenizer::isWordChar(t[start-1]))
+        start--;
+    completionPrefix = t.mid(start, end-start);
+    QStringList words;
+    if (!cursor.hasSelection() && (force || completionPrefix.size() >= 2) &&
+            (completionPrefix.isEmpty() || completionPrefix[0].isLetter()))
+        words = CompletionIndex::instance()->complete(completionPrefix, document(), maxCompletions);
+    if (words.isEmpty()) {
+        completer->popup()->hide();
+        return;
+    }
+    completionModel->setStringList(words);
+    completer->popup()->setCurrentIndex(completionModel->index(0, 0));
+    QRect r = cursorRect();
+    r.setWidth(completer->popup()->sizeHintForColumn(0)+
+               completer->popup()->verticalScrollBar()->sizeHint().width());
+    completer->complete(r);
+}
+
+void CodeEditor::insertCompletion(const QString& word)
+{
+    QTextCursor cursor(textCursor());
+    cursor.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, completionPrefix.size());
+    cursor.insertText(word);
+    setTextCursor(cursor);
+}
+
+void CodeEditor::indentLine(QTextCursor& cursor)
+{
+    // Replace the leading white space of the cursor's line, keeping the
+    // cursor at the same position relative to the text after it
+    QTextBlock block = cursor.block();
+    int indent = indentEngine->indentation(block);
+    if (indent == -1)
+        return;
+    QString t = block.text();
+    int ws = 0;
+    while (ws < t.size() && t[ws].isSpace())
+        ws++;
+    if (ws == indent)
+        return;
+    int col = std::max(0, cursor.positionInBlock()-ws);
+    QTextCursor c(block);
+    c.setPosition(block.position()+ws, QTextCursor::KeepAnchor);
+    c.insertText(QString(indent, ' '));
+    cursor.setPosition(block.position()+indent+col);
+}
+
+void CodeEditor::reindent(void)
+{
+    bool hasSelection = textCursor().hasSelection();
+    for (int i=0; i<extraCursors.size() && !hasSelection; i++)
+        hasSelection = extraCursors[i].hasSelection();
+    QMap<int,QTextBlock> blocks;
+    if (hasSelection) {
+        blocks = selectedBlocks();
+    } else {
+        int n = 0;
+        for (QTextBlock block = document()->begin(); block.isValid(); block = block.next(), n++)
+            blocks.insert(n, block);
+    }
+    // Depths are computed before any edit is applied, so each line only
+    // costs a step from the previous one
+    QVector<Edit> edits;
+    for (QMap<int,QTextBlock>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        QString t = it.value().text();
+        int ws = 0;
+        while (ws < t.size() && t[ws].isSpace())
+            ws++;
+        if (ws == t.size())
+            continue;
+        int indent = indentEngine->indentation(it.value());
+        if (indent != -1 && indent != ws)
+            edits.append(Edit(it.value().position(), ws, QString(indent, ' ')));
+    }
+    applyEdits(edits);
+}
+
 int CodeEditor::lineNumbersWidth()
 {
     int width = 1;
@@ -136,7 +338,12 @@ int CodeEditor::lineNumbersWidth()
         ++width;
     }
     width = std::max(width,3);
-    return 3 + fontMetrics().width(QLatin1Char('9')) * width;
+    return 3 + fontMetrics().width(QLatin1Char('9')) * width + foldMarkerWidth();
+}
+
+int CodeEditor::foldMarkerWidth(void)
+{
+    return fontMetrics().height()*3/4;
 }
 
 
@@ -174,17 +381,48 @@ void CodeEditor::resizeEvent(QResizeEvent *e)
 
 
 
+namespace {
+    bool bracketBefore(const Bracket& b, int pos)
+    {
+        return b.pos < pos;
+    }
+}
+
 void CodeEditor::cursorChange()
 {
-    QList<QTextEdit::ExtraSelection> extraSelections;
+    TRACE_SPAN("CodeEditor::cursorChange");
+    if (!textCursor().block().isVisible()) {
+        // The cursor was moved into a folded region (e.g. by find or go to line)
+        QTextBlock start = textCursor().block();
+        while (start.isValid() && !start.isVisible())
+            start = start.previous();
+        setFolded(start, false);
+        if (!textCursor().block().isVisible()) {
+            // The region has changed since it was folded
+            QTextBlock end = textCursor().block();
+            for (QTextBlock block = start.next(); block.isValid(); block = block.next()) {
+                block.setVisible(true);
+                if (block==end)
+                    break;
+            }
+            document()->markContentsDirty(start.position(), end.position()+end.length()-start.position());
+        }
+    }
+
+    QList<QTextEdit::ExtraSelection> extraSelections = diagnosticSelections;
 
     BracketData* bd = static_cast<BracketData*>(textCursor().block().userData());
 
     if (bd) {
         QVector<Bracket>& brackets = bd->brackets;
         int pos = textCursor().block().position();
-        for (int i=0; i<brackets.size(); i++) {
-            int curPos = textCursor().position()-textCursor().block().position();
+        int curPos = textCursor().position()-pos;
+        // Brackets are sorted by position, so find the one before the cursor
+        // directly instead of walking all brackets of (possibly very long) lines
+        QVector<Bracket>::iterator it =
+                std::lower_bound(brackets.begin(), brackets.end(), curPos-1, bracketBefore);
+        if (it != brackets.end() && it->pos == curPos-1) {
+            int i = it-brackets.begin();
             Bracket& b = brackets[i];
             int parenPos0 = -1;
             int parenPos1 = -1;
@@ -233,6 +471,16 @@ void CodeEditor::cursorChange()
         }
     }
 
+    for (int i=0; i<extraCursors.size(); i++) {
+        if (extraCursors[i].hasSelection()) {
+            QTextEdit::ExtraSelection sel;
+            sel.format.setBackground(palette().color(QPalette::Highlight));
+            sel.format.setForeground(palette().color(QPalette::HighlightedText));
+            sel.cursor = extraCursors[i];
+            extraSelections.append(sel);
+        }
+    }
+
     setExtraSelections(extraSelections);
 }
 
@@ -248,6 +496,8 @@ int CodeEditor::matchLeft(QTextBlock block, QChar b, int i, int nLeft)
 
     while (block.isValid()) {
         BracketData* bd = static_cast<BracketData*>(block.userData());
+        if (bd==NULL)
+            return -1;
         QVector<Bracket>& brackets = bd->brackets;
         int docPos = block.position();
         for (; i<brackets.size(); i++) {
@@ -279,6 +529,8 @@ int CodeEditor::matchRight(QTextBlock block, QChar b, int i, int nRight)
         block = block.previous();
     while (block.isValid()) {
         BracketData* bd = static_cast<BracketData*>(block.userData());
+        if (bd==NULL)
+            return -1;
         QVector<Bracket>& brackets = bd->brackets;
         if (i==-1)
             i = brackets.size()-1;
@@ -317,6 +569,8 @@ void CodeEditor::paintLineNumbers(QPaintEvent *event)
     int bottom = top + (int) blockBoundingRect(block).height();
 
     int curLine = textCursor().blockNumber();
+    int markerWidth = foldMarkerWidth();
+    int numbersWidth = lineNumbers->width()-markerWidth;
 
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
@@ -326,23 +580,212 @@ void CodeEditor::paintLineNumbers(QPaintEvent *event)
             else
                 painter.setPen(Qt::gray);
             int textTop = top+fontMetrics().leading()+heightDiff;
-            painter.drawText(0, textTop, lineNumbers->width(), fm2.height(),
+            painter.drawText(0, textTop, numbersWidth, fm2.height(),
                              Qt::AlignRight, number);
+            if (isFoldStart(block)) {
+                // Right-pointing triangle for folded regions, down-pointing otherwise
+                qreal s = markerWidth/4.0;
+                QPointF c(numbersWidth+markerWidth/2.0, top+fontMetrics().height()/2.0);
+                QPolygonF marker;
+                if (isFolded(block)) {
+                    marker << c+QPointF(-s,-1.5*s) << c+QPointF(s,0) << c+QPointF(-s,1.5*s);
+                } else {
+                    marker << c+QPointF(-1.5*s,-s) << c+QPointF(1.5*s,-s) << c+QPointF(0,s);
+                }
+                painter.save();
+                painter.setRenderHint(QPainter::Antialiasing);
+                painter.setPen(Qt::NoPen);
+                painter.setBrush(Qt::gray);
+                painter.drawPolygon(marker);
+                painter.restore();
+            }
         }
 
         block = block.next();
+        ++blockNumber;
+        // Folded blocks take no space, so skip them without asking for their geometry
+        while (block.isValid() && !block.isVisible()) {
+            block = block.next();
+            ++blockNumber;
+        }
         top = bottom;
         bottom = top + (int) blockBoundingRect(block).height();
-        ++blockNumber;
     }
 }
 
+bool CodeEditor::isFoldStart(const QTextBlock& block) const
+{
+    if (block.userState()==1 && block.previous().userState()!=1)
+        return true;
+    BracketData* bd = static_cast<BracketData*>(block.userData());
+    return bd && bd->foldOpen != -1;
+}
+
+bool CodeEditor::isFolded(const QTextBlock& block) const
+{
+    return isFoldStart(block) && block.next().isValid() && !block.next().isVisible();
+}
+
+QTextBlock CodeEditor::foldEnd(const QTextBlock& start) const
+{
+    if (start.userState()==1 && start.previous().userState()!=1) {
+        // A block comment, fold up to the line that closes it
+        QTextBlock block = start.next();
+        while (block.isValid() && block.userState()==1)
+            block = block.next();
+        return block;
+    }
+    BracketData* bd = static_cast<BracketData*>(start.userData());
+    if (bd==NULL || bd->foldOpen==-1)
+        return QTextBlock();
+    int depth = 0;
+    int i = bd->foldOpen+1;
+    for (QTextBlock block = start; block.isValid(); block = block.next()) {
+        BracketData* d = static_cast<BracketData*>(block.userData());
+        for (; d && i<d->brackets.size(); i++) {
+            QChar b = d->brackets[i].b;
+            if (b=='(' || b=='{' || b=='[') {
+                depth++;
+            } else if (depth > 0) {
+                depth--;
+            } else {
+                // Keep a closing bracket that starts its line visible
+                if (block != start && block.text().left(d->brackets[i].pos).trimmed().isEmpty())
+                    return block.previous();
+                return block;
+            }
+        }
+        i = 0;
+    }
+    return QTextBlock();
+}
+
+void CodeEditor::setFolded(const QTextBlock& start, bool fold)
+{
+    QTextBlock end = foldEnd(start);
+    if (!end.isValid() || end.blockNumber() <= start.blockNumber())
+        return;
+    for (QTextBlock block = start.next(); block.isValid(); block = block.next()) {
+        block.setVisible(!fold);
+        if (block==end)
+            break;
+    }
+    document()->markContentsDirty(start.position(), end.position()+end.length()-start.position());
+    moveCursorOutOfFolds();
+    viewport()->update();
+    lineNumbers->update();
+}
+
+void CodeEditor::moveCursorOutOfFolds(void)
+{
+    QTextBlock block = textCursor().block();
+    if (block.isVisible())
+        return;
+    while (block.isValid() && !block.isVisible())
+        block = block.previous();
+    QTextCursor cursor = textCursor();
+    cursor.setPosition(block.position()+block.length()-1);
+    setTextCursor(cursor);
+}
+
+namespace {
+    struct OpenBracket {
+        QTextBlock block;
+        int line;
+        QChar b;
+    };
+}
+
+void CodeEditor::foldArrays(int minLines)
+{
+    // Find all arrays in a single pass over the bracket data, collecting
+    // the first and last line to hide ordered by the line they start on.
+    // An array need not start the fold region of its line, as in
+    // "x = array2d(1..n,1..m,[", so its extent is taken from its brackets.
+    QVector<OpenBracket> open;
+    QMap<int,QPair<QTextBlock,QTextBlock> > starts;
+    int line = 0;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next(), line++) {
+        BracketData* bd = static_cast<BracketData*>(block.userData());
+        if (bd==NULL)
+            continue;
+        for (int i=0; i<bd->brackets.size(); i++) {
+            QChar b = bd->brackets[i].b;
+            if (b=='(' || b=='{' || b=='[') {
+                OpenBracket ob;
+                ob.block = block;
+                ob.line = line;
+                ob.b = b;
+                open.append(ob);
+            } else if (!open.isEmpty()) {
+                const OpenBracket& ob = open.last();
+                if (ob.b=='[' && line-ob.line >= minLines) {
+                    // Keep a closing bracket that starts its line visible
+                    QTextBlock end = block;
+                    if (block.text().left(bd->brackets[i].pos).trimmed().isEmpty())
+                        end = block.previous();
+                    // The outermost array of a line closes last and wins
+                    if (end.blockNumber() > ob.line)
+                        starts.insert(ob.line, qMakePair(ob.block, end));
+                }
+                open.pop_back();
+            }
+        }
+    }
+    int first = -1;
+    int last = 0;
+    for (QMap<int,QPair<QTextBlock,QTextBlock> >::iterator it = starts.begin(); it != starts.end(); ++it) {
+        QTextBlock start = it.value().first;
+        QTextBlock end = it.value().second;
+        // Arrays nested in an array that was just folded are already hidden
+        if (!start.isVisible() || isFolded(start))
+            continue;
+        for (QTextBlock block = start.next(); block.isValid(); block = block.next()) {
+            block.setVisible(false);
+            if (block==end)
+                break;
+        }
+        if (first==-1)
+            first = start.position();
+        last = end.position()+end.length();
+    }
+    if (first != -1) {
+        document()->markContentsDirty(first, last-first);
+        moveCursorOutOfFolds();
+        viewport()->update();
+        lineNumbers->update();
+    }
+}
+
+void CodeEditor::unfoldAll(void)
+{
+    bool changed = false;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        if (!block.isVisible()) {
+            block.setVisible(true);
+            changed = true;
+        }
+    }
+    if (changed) {
+        document()->markContentsDirty(0, document()->characterCount());
+        viewport()->update();
+        lineNumbers->update();
+    }
+}
+
+void CodeEditor::lineNumbersClicked(const QPoint& p)
+{
+    if (p.x() < lineNumbers->width()-foldMarkerWidth())
+        return;
+    QTextBlock block = cursorForPosition(QPoint(0, p.y())).block();
+    if (isFoldStart(block))
+        setFolded(block, !isFolded(block));
+}
+
 void CodeEditor::setEditorFont(QFont& font)
 {
     setFont(font);
     document()->setDefaultFont(font);
-    highlighter->setEditorFont(font);
-    highlighter->rehighlight();
 }
 
 bool CodeEditor::eventFilter(QObject *, QEvent *ev)
@@ -371,3 +814,387 @@ void CodeEditor::cut()
     highlighter->copyHighlightedToClipboard(textCursor());
     textCursor().removeSelectedText();
 }
+
+namespace {
+    bool editAfter(const CodeEditor::Edit& e0, const CodeEditor::Edit& e1)
+    {
+        return e0.pos > e1.pos;
+    }
+}
+
+void CodeEditor::applyEdits(QVector<Edit> edits)
+{
+    if (edits.isEmpty())
+        return;
+    // Apply the edits back to front so that the positions of the remaining
+    // ones stay valid. The edit block makes this a single undo step, and
+    // the document layout is only updated once it ends.
+    std::sort(edits.begin(), edits.end(), editAfter);
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    int prev = document()->characterCount();
+    for (int i=0; i<edits.size(); i++) {
+        const Edit& e = edits[i];
+        if (e.pos < 0 || e.pos+e.removed > prev)
+            continue;
+        cursor.setPosition(e.pos);
+        if (e.removed > 0) {
+            cursor.setPosition(e.pos+e.removed, QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+        }
+        if (!e.text.isEmpty())
+            cursor.insertText(e.text);
+        prev = e.pos;
+    }
+    cursor.endEditBlock();
+}
+
+QList<QTextCursor> CodeEditor::allCursors(void) const
+{
+    QList<QTextCursor> cursors = extraCursors;
+    cursors.prepend(textCursor());
+    return cursors;
+}
+
+QMap<int,QTextBlock> CodeEditor::selectedBlocks(void) const
+{
+    QMap<int,QTextBlock> blocks;
+    QList<QTextCursor> cursors = allCursors();
+    for (int i=0; i<cursors.size(); i++) {
+        QTextBlock block = document()->findBlock(cursors[i].selectionStart());
+        QTextBlock last = document()->findBlock(cursors[i].selectionEnd());
+        for (int n = block.blockNumber(); block.isValid(); block = block.next(), n++) {
+            blocks.insert(n, block);
+            if (block==last)
+                break;
+        }
+    }
+    return blocks;
+}
+
+void CodeEditor::shiftLeft(void)
+{
+    QMap<int,QTextBlock> blocks = selectedBlocks();
+    QVector<Edit> edits;
+    for (QMap<int,QTextBlock>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        QString t = it.value().text();
+        int n = 0;
+        while (n < 2 && n < t.size() && t[n].isSpace())
+            n++;
+        if (n > 0)
+            edits.append(Edit(it.value().position(), n));
+    }
+    applyEdits(edits);
+}
+
+void CodeEditor::shiftRight(void)
+{
+    QMap<int,QTextBlock> blocks = selectedBlocks();
+    QVector<Edit> edits;
+    for (QMap<int,QTextBlock>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+        edits.append(Edit(it.value().position(), 0, "  "));
+    applyEdits(edits);
+}
+
+void CodeEditor::toggleComment(void)
+{
+    QMap<int,QTextBlock> blocks = selectedBlocks();
+    // Uncomment if all lines are either empty or comments
+    bool isCommented = true;
+    QVector<int> firstNonSpace;
+    firstNonSpace.reserve(blocks.size());
+    for (QMap<int,QTextBlock>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        QString t = it.value().text();
+        int i = 0;
+        while (i < t.size() && t[i].isSpace())
+            i++;
+        firstNonSpace.append(i < t.size() ? i : -1);
+        if (i < t.size() && t[i] != '%')
+            isCommented = false;
+    }
+    QVector<Edit> edits;
+    int k = 0;
+    for (QMap<int,QTextBlock>::iterator it = blocks.begin(); it != blocks.end(); ++it, k++) {
+        int i = firstNonSpace[k];
+        if (i == -1)
+            continue;
+        if (isCommented) {
+            QString t = it.value().text();
+            bool haveSpace = i+1 < t.size() && t[i+1].isSpace();
+            edits.append(Edit(it.value().position()+i, haveSpace ? 2 : 1));
+        } else {
+            edits.append(Edit(it.value().position(), 0, "% "));
+        }
+    }
+    applyEdits(edits);
+}
+
+void CodeEditor::clearExtraCursors()
+{
+    if (!extraCursors.isEmpty()) {
+        extraCursors.clear();
+        cursorChange();
+        viewport()->update();
+    }
+}
+
+void CodeEditor::mergeCursors(void)
+{
+    // Cursors that have run into each other (e.g. after deleting the text
+    // between them) are merged
+    QSet<int> seen;
+    seen.insert(textCursor().position());
+    for (int i=0; i<extraCursors.size(); i++) {
+        if (seen.contains(extraCursors[i].position())) {
+            extraCursors.removeAt(i--);
+        } else {
+            seen.insert(extraCursors[i].position());
+        }
+    }
+}
+
+void CodeEditor::addCursorLine(bool above)
+{
+    QTextCursor cursor = textCursor();
+    int col = cursor.positionInBlock();
+    QTextBlock block = cursor.block();
+    do {
+        block = above ? block.previous() : block.next();
+    } while (block.isValid() && !block.isVisible());
+    if (!block.isValid())
+        return;
+    extraCursors.append(cursor);
+    cursor.setPosition(block.position()+std::min(col, block.length()-1));
+    setTextCursor(cursor);
+    mergeCursors();
+    viewport()->update();
+}
+
+bool CodeEditor::multiCursorKey(QKeyEvent *e)
+{
+    if (e->key() == Qt::Key_Escape) {
+        clearExtraCursors();
+        return true;
+    }
+    if (e->modifiers() & (Qt::ControlModifier | Qt::MetaModifier))
+        return false;
+    QList<QTextCursor> cursors = allCursors();
+
+    QTextCursor::MoveOperation op = QTextCursor::NoMove;
+    switch (e->key()) {
+    case Qt::Key_Left: op = QTextCursor::Left; break;
+    case Qt::Key_Right: op = QTextCursor::Right; break;
+    case Qt::Key_Up: op = QTextCursor::Up; break;
+    case Qt::Key_Down: op = QTextCursor::Down; break;
+    case Qt::Key_Home: op = QTextCursor::StartOfBlock; break;
+    case Qt::Key_End: op = QTextCursor::EndOfBlock; break;
+    default: break;
+    }
+    if (op != QTextCursor::NoMove) {
+        QTextCursor::MoveMode mode = (e->modifiers() & Qt::ShiftModifier) ?
+                    QTextCursor::KeepAnchor : QTextCursor::MoveAnchor;
+        for (int i=0; i<cursors.size(); i++)
+            cursors[i].movePosition(op, mode);
+        extraCursors = cursors.mid(1);
+        setTextCursor(cursors[0]);
+        mergeCursors();
+        cursorChange();
+        viewport()->update();
+        return true;
+    }
+
+    QVector<Edit> edits;
+    if (e->key() == Qt::Key_Backspace || e->key() == Qt::Key_Delete) {
+        bool back = e->key() == Qt::Key_Backspace;
+        for (int i=0; i<cursors.size(); i++) {
+            const QTextCursor& c = cursors[i];
+            if (c.hasSelection()) {
+                edits.append(Edit(c.selectionStart(), c.selectionEnd()-c.selectionStart()));
+            } else if (back && c.position() > 0) {
+                edits.append(Edit(c.position()-1, 1));
+            } else if (!back && c.position() < document()->characterCount()-1) {
+                edits.append(Edit(c.position(), 1));
+            }
+        }
+    } else {
+        QString text;
+        if (e->key() == Qt::Key_Tab) {
+            text = "  ";
+        } else if (e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) {
+            text = "\n";
+        } else if (!e->text().isEmpty() && e->text()[0].isPrint()) {
+            text = e->text();
+        } else {
+            return false;
+        }
+        for (int i=0; i<cursors.size(); i++) {
+            const QTextCursor& c = cursors[i];
+            edits.append(Edit(c.selectionStart(), c.selectionEnd()-c.selectionStart(), text));
+        }
+    }
+    // The cursors move along with the edits
+    applyEdits(edits);
+    mergeCursors();
+    ensureCursorVisible();
+    cursorChange();
+    viewport()->update();
+    return true;
+}
+
+int CodeEditor::columnAt(const QPoint& p) const
+{
+    qreal x = p.x()-contentOffset().x()-document()->documentMargin();
+    return std::max(0, qRound(x/QFontMetricsF(font()).width(' ')));
+}
+
+void CodeEditor::setColumnSelection(int anchorBlock, int anchorCol, int curBlock, int curCol)
+{
+    int first = std::min(anchorBlock, curBlock);
+    int last = std::max(anchorBlock, curBlock);
+    QTextCursor main;
+    extraCursors.clear();
+    QTextBlock block = document()->findBlockByNumber(first);
+    for (int n = first; block.isValid() && n <= last; block = block.next(), n++) {
+        if (!block.isVisible())
+            continue;
+        int len = block.length()-1;
+        QTextCursor c(block);
+        c.setPosition(block.position()+std::min(anchorCol, len));
+        c.setPosition(block.position()+std::min(curCol, len), QTextCursor::KeepAnchor);
+        if (n==curBlock) {
+            main = c;
+        } else {
+            extraCursors.append(c);
+        }
+    }
+    if (main.isNull()) {
+        if (extraCursors.isEmpty())
+            return;
+        main = extraCursors.takeLast();
+    }
+    setTextCursor(main);
+    cursorChange();
+    viewport()->update();
+}
+
+void CodeEditor::mousePressEvent(QMouseEvent *e)
+{
+    if (e->button() == Qt::LeftButton && (e->modifiers() & Qt::AltModifier)) {
+        columnSelecting = true;
+        columnDragged = false;
+        columnAnchorBlock = cursorForPosition(e->pos()).blockNumber();
+        columnAnchorCol = columnAt(e->pos());
+        e->accept();
+        return;
+    }
+    clearExtraCursors();
+    QPlainTextEdit::mousePressEvent(e);
+}
+
+void CodeEditor::mouseMoveEvent(QMouseEvent *e)
+{
+    if (columnSelecting) {
+        columnDragged = true;
+        setColumnSelection(columnAnchorBlock, columnAnchorCol,
+                           cursorForPosition(e->pos()).blockNumber(), columnAt(e->pos()));
+        e->accept();
+        return;
+    }
+    QPlainTextEdit::mouseMoveEvent(e);
+}
+
+void CodeEditor::mouseReleaseEvent(QMouseEvent *e)
+{
+    if (columnSelecting) {
+        columnSelecting = false;
+        if (!columnDragged) {
+            // Alt+click adds a cursor
+            extraCursors.append(textCursor());
+            setTextCursor(cursorForPosition(e->pos()));
+            mergeCursors();
+            cursorChange();
+            viewport()->update();
+        }
+        e->accept();
+        return;
+    }
+    QPlainTextEdit::mouseReleaseEvent(e);
+}
+
+void CodeEditor::paintEvent(QPaintEvent *e)
+{
+    QPlainTextEdit::paintEvent(e);
+    if (extraCursors.isEmpty())
+        return;
+    QPainter painter(viewport());
+    QColor color = darkMode ? Qt::white : Qt::black;
+    for (int i=0; i<extraCursors.size(); i++) {
+        QRect r = cursorRect(extraCursors[i]);
+        if (r.intersects(e->rect()))
+            painter.fillRect(r.x(), r.y(), cursorWidth(), r.height(), color);
+    }
+}
+
+void CodeEditor::setDiagnostics(const QVector<Diagnostic>& d, DiagnosticSource source)
+{
+    diagnostics[source] = d;
+    diagnosticSelections.clear();
+    for (int s=0; s<NumDiagnosticSources; s++) {
+        for (int i=0; i<diagnostics[s].size(); i++) {
+            const Diagnostic& diag = diagnostics[s][i];
+            QTextBlock block = document()->findBlockByNumber(diag.line);
+            if (!block.isValid())
+                continue;
+            // Underline the word at the reported column, or at least one character
+            QString t = block.text();
+            int start = std::max(0, std::min(diag.col, t.size()-1));
+            int end = start;
+            while (end < t.size() && (t[end].isLetterOrNumber() || t[end]=='_'))
+                end++;
+            if (end==start)
+                end = std::min(start+1, t.size());
+            QTextEdit::ExtraSelection sel;
+            sel.format.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+            sel.format.setUnderlineColor(diag.warning ? QColor(255,140,0) : QColor(Qt::red));
+            sel.format.setToolTip(diag.message);
+            sel.cursor = QTextCursor(block);
+            sel.cursor.setPosition(block.position()+start);
+            sel.cursor.setPosition(block.position()+end, QTextCursor::KeepAnchor);
+            diagnosticSelections.append(sel);
+        }
+    }
+    cursorChange();
+}
+
+void CodeEditor::setTypes(const QHash<QString,QString>& t)
+{
+    types = t;
+}
+
+bool CodeEditor::viewportEvent(QEvent *e)
+{
+    if (e->type() == QEvent::ToolTip) {
+        QHelpEvent* he = static_cast<QHelpEvent*>(e);
+        QTextCursor cursor = cursorForPosition(he->pos());
+        int pos = cursor.position();
+        // The selections follow edits, so they are still at the right place
+        for (int i=0; i<diagnosticSelections.size(); i++) {
+            const QTextCursor& c = diagnosticSelections[i].cursor;
+            if (pos >= c.selectionStart() && pos <= c.selectionEnd()) {
+                QToolTip::showText(he->globalPos(), diagnosticSelections[i].format.toolTip(), viewport());
+                return true;
+            }
+        }
+        cursor.select(QTextCursor::WordUnderCursor);
+        QString word = cursor.selectedText();
+        QHash<QString,QString>::const_iterator it = types.find(word);
+        if (it != types.end()) {
+            QToolTip::showText(he->globalPos(), it.value()+": "+word, viewport());
+        } else {
+            QToolTip::hideText();
+            e->ignore();
+        }
+        return true;
+    }
+    return QPlainTextEdit::viewportEvent(e);
+}
@@ -15,8 +15,15 @@
 
 #include <QPlainTextEdit>
 #include <QTabWidget>
+#include <QMouseEvent>
+#include <QMap>
+#include <QHash>
 
 #include "highlighter.h"
+#include "indentengine.h"
+
+class QCompleter;
+class QStringListModel;
 
 class CodeEditor : public QPlainTextEdit
 {
@@ -28,32 +35,133 @@ public:
     int lineNumbersWidth();
     QString filepath;
     QString filename;
+    /// Whether the editor has released its document to save memory (see
+    /// MainWindow::hibernateEditor), and the view state to restore
+    bool hibernated;
+    int hibernatedAnchor;
+    int hibernatedPosition;
+    int hibernatedScroll;
+    int hibernatedHScroll;
+    /// When the editor was last shown (milliseconds since the epoch)
+    qint64 lastViewed;
     void setEditorFont(QFont& font);
     void setDocument(QTextDocument *document);
     void setDarkMode(bool);
+    /// Release the layouts, formats and block data of the document, which
+    /// no visible editor shows (see Highlighter::release)
+    void releaseFormatting(void) { highlighter->release(); }
+    /// Highlight the document again if its formatting was released
+    void restoreFormatting(void) { highlighter->restore(); }
+    bool formattingReleased(void) const { return highlighter->isReleased(); }
+    /// The highlighting formats used for each Tokenizer::TokenClass
+    const QVector<QTextCharFormat>& tokenFormats(void) const { return highlighter->tokenFormats(); }
+    /// Fold all array literals that span more than \a minLines lines
+    void foldArrays(int minLines);
+    /// Show all folded regions
+    void unfoldAll(void);
+    void lineNumbersClicked(const QPoint& p);
+
+    /// Replacement of \a removed characters at position \a pos by \a text
+    struct Edit {
+        int pos;
+        int removed;
+        QString text;
+        Edit(int p=0, int r=0, const QString& t=QString()) : pos(p), removed(r), text(t) {}
+    };
+    /// Apply non-overlapping \a edits as a single undoable change, so that
+    /// the document is only laid out again once
+    void applyEdits(QVector<Edit> edits);
+    /// Unindent all lines touched by any of the cursors
+    void shiftLeft(void);
+    /// Indent all lines touched by any of the cursors
+    void shiftRight(void);
+    /// Comment or uncomment all lines touched by any of the cursors
+    void toggleComment(void);
+    /// Re-indent all lines touched by any of the cursors, or the whole file
+    /// if nothing is selected
+    void reindent(void);
+
+    /// An error or warning at a (0-based) line and column
+    struct Diagnostic {
+        int line;
+        int col;
+        QString message;
+        bool warning;
+        Diagnostic(int l=0, int c=0, const QString& m=QString(), bool w=false)
+            : line(l), col(c), message(m), warning(w) {}
+    };
+    /// Diagnostics from the background check and from the last run are kept apart
+    enum DiagnosticSource { CheckDiagnostics=0, RunDiagnostics, NumDiagnosticSources };
+    /// Underline \a diagnostics and show their messages when hovering them,
+    /// replacing the previous diagnostics from \a source
+    void setDiagnostics(const QVector<Diagnostic>& diagnostics, DiagnosticSource source=CheckDiagnostics);
+    /// Set the types of identifiers, shown when hovering them
+    void setTypes(const QHash<QString,QString>& types);
 protected:
     void resizeEvent(QResizeEvent *event);
     void initUI(QFont& font);
     virtual void keyPressEvent(QKeyEvent *e);
     bool eventFilter(QObject *, QEvent *);
+    void paintEvent(QPaintEvent *e);
+    void mousePressEvent(QMouseEvent *e);
+    void mouseMoveEvent(QMouseEvent *e);
+    void mouseReleaseEvent(QMouseEvent *e);
+    bool viewportEvent(QEvent *e);
 private slots:
     void setLineNumbersWidth(int newBlockCount);
     void cursorChange();
     void setLineNumbers(const QRect &, int);
     void docChanged(bool);
     void loadContents();
+    void longBlockFound();
+    void insertCompletion(const QString& word);
+    /// Apply the current colours to the visible blocks that still have old ones
+    void refreshVisibleFormats(void);
 private:
     QWidget* lineNumbers;
     QWidget* loadContentsButton;
     QTabWidget* tabs;
     Highlighter* highlighter;
+    IndentEngine* indentEngine;
+    QCompleter* completer;
+    QStringListModel* completionModel;
+    /// The part of the word before the cursor that the completions extend
+    QString completionPrefix;
     bool darkMode;
+    /// Cursors in addition to textCursor(), created by Alt+click, Alt+drag
+    /// (column selection) or Alt+Shift+Up/Down
+    QList<QTextCursor> extraCursors;
+    QVector<Diagnostic> diagnostics[NumDiagnosticSources];
+    QList<QTextEdit::ExtraSelection> diagnosticSelections;
+    QHash<QString,QString> types;
+    bool columnSelecting;
+    bool columnDragged;
+    int columnAnchorBlock;
+    int columnAnchorCol;
+    QList<QTextCursor> allCursors(void) const;
+    QMap<int,QTextBlock> selectedBlocks(void) const;
+    int columnAt(const QPoint& p) const;
+    void setColumnSelection(int anchorBlock, int anchorCol, int block, int col);
+    void addCursorLine(bool above);
+    bool multiCursorKey(QKeyEvent *e);
+    void mergeCursors(void);
+    void indentLine(QTextCursor& cursor);
+    /// Show the completions of the word before the cursor, if it has at
+    /// least two characters (or any, if \a force is set)
+    void updateCompletion(bool force);
     int matchLeft(QTextBlock block, QChar b, int i, int n);
     int matchRight(QTextBlock block, QChar b, int i, int n);
+    int foldMarkerWidth(void);
+    bool isFoldStart(const QTextBlock& block) const;
+    bool isFolded(const QTextBlock& block) const;
+    QTextBlock foldEnd(const QTextBlock& start) const;
+    void setFolded(const QTextBlock& start, bool fold);
+    void moveCursorOutOfFolds(void);
 signals:
 
 public slots:
     void loadedLargeFile();
+    void clearExtraCursors();
     void copy();
     void cut();
 };
@@ -72,6 +180,10 @@ protected:
         codeEditor->paintLineNumbers(event);
     }
 
+    void mousePressEvent(QMouseEvent *event) {
+        codeEditor->lineNumbersClicked(event->pos());
+    }
+
 private:
     CodeEditor *codeEditor;
 };
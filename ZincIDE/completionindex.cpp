@@ -0,0 +1,119 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "completionindex.h"
+#include "tokenizer.h"
+
+#include <QVector>
+
+#include <algorithm>
+
+namespace {
+    struct Candidate {
+        int tier;
+        int count;
+        QString word;
+        Candidate(int t=0, int c=0, const QString& w=QString()) : tier(t), count(c), word(w) {}
+        bool operator <(const Candidate& c) const {
+            if (tier != c.tier)
+                return tier > c.tier;
+            if (count != c.count)
+                return count > c.count;
+            return word < c.word;
+        }
+    };
+}
+
+CompletionIndex* CompletionIndex::instance(void)
+{
+    static CompletionIndex index;
+    return &index;
+}
+
+CompletionIndex::CompletionIndex(void)
+{
+    QStringList keywords = Tokenizer::keywords();
+    for (int i=0; i<keywords.size(); i++)
+        _words[keywords[i]].keyword = true;
+}
+
+void CompletionIndex::addWords(const QTextDocument* doc, const QStringList& words)
+{
+    if (words.isEmpty())
+        return;
+    QHash<QString,int>& docWords = _documentWords[doc];
+    for (int i=0; i<words.size(); i++) {
+        _words[words[i]].count++;
+        docWords[words[i]]++;
+    }
+}
+
+void CompletionIndex::removeWords(const QTextDocument* doc, const QStringList& words)
+{
+    if (words.isEmpty())
+        return;
+    QHash<const QTextDocument*,QHash<QString,int> >::iterator d = _documentWords.find(doc);
+    if (d == _documentWords.end())
+        return;
+    for (int i=0; i<words.size(); i++) {
+        QHash<QString,int>::iterator dw = d.value().find(words[i]);
+        if (dw == d.value().end())
+            continue;
+        if (--dw.value() == 0)
+            d.value().erase(dw);
+        QMap<QString,Word>::iterator w = _words.find(words[i]);
+        if (w != _words.end() && --w.value().count <= 0 && !w.value().keyword && !w.value().library)
+            _words.erase(w);
+    }
+    if (d.value().isEmpty())
+        _documentWords.erase(d);
+}
+
+void CompletionIndex::setLibrary(const QStringList& names)
+{
+    for (int i=0; i<_library.size(); i++) {
+        QMap<QString,Word>::iterator w = _words.find(_library[i]);
+        if (w == _words.end())
+            continue;
+        w.value().library = false;
+        if (w.value().count <= 0 && !w.value().keyword)
+            _words.erase(w);
+    }
+    _library = names;
+    for (int i=0; i<_library.size(); i++)
+        _words[_library[i]].library = true;
+}
+
+QStringList CompletionIndex::complete(const QString& prefix, const QTextDocument* doc, int max) const
+{
+    if (max <= 0)
+        return QStringList();
+    QHash<QString,int> docWords = _documentWords.value(doc);
+    // Short prefixes can match a large part of the index, so the best
+    // matches are kept in a heap of at most max entries while scanning,
+    // with the worst of them on top
+    QVector<Candidate> best;
+    for (QMap<QString,Word>::const_iterator it = _words.lowerBound(prefix);
+         it != _words.end() && it.key().startsWith(prefix); ++it) {
+        // The word being typed is counted in the document as well
+        if (it.key().size() == prefix.size())
+            continue;
+        const Word& w = it.value();
+        int tier = docWords.contains(it.key()) ? 2 : (w.keyword || w.library ? 1 : 0);
+        Candidate c(tier, w.count, it.key());
+        if (best.size() < max) {
+            best.append(c);
+            std::push_heap(best.begin(), best.end());
+        } else if (c < best.front()) {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = c;
+            std::push_heap(best.begin(), best.end());
+        }
+    }
+    std::sort_heap(best.begin(), best.end());
+    QStringList result;
+    for (int i=0; i<best.size(); i++)
+        result.append(best[i].word);
+    return result;
+}
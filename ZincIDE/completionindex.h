@@ -0,0 +1,50 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef COMPLETIONINDEX_H
+#define COMPLETIONINDEX_H
+
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+
+class QTextDocument;
+
+/// Words offered for completion: the keywords, the identifiers used in
+/// the open documents and the predicates and functions of the libraries.
+///
+/// The words are kept in a sorted map, so the completions of a prefix are
+/// found by a binary search followed by a scan of the matching range.
+/// Identifiers are counted per document as blocks are highlighted (see
+/// BracketData), so the index follows edits without rescanning documents.
+class CompletionIndex
+{
+public:
+    static CompletionIndex* instance(void);
+
+    /// Count the occurrences of \a words in \a doc
+    void addWords(const QTextDocument* doc, const QStringList& words);
+    /// Remove occurrences of \a words in \a doc counted by addWords
+    void removeWords(const QTextDocument* doc, const QStringList& words);
+    /// Set the names of the library predicates and functions
+    void setLibrary(const QStringList& names);
+
+    /// At most \a max completions of \a prefix, best first: identifiers
+    /// used in \a doc, then keywords and library names, then identifiers
+    /// from other documents, each ranked by how often they are used
+    QStringList complete(const QString& prefix, const QTextDocument* doc, int max) const;
+private:
+    CompletionIndex(void);
+    struct Word {
+        int count;
+        bool keyword;
+        bool library;
+        Word(void) : count(0), keyword(false), library(false) {}
+    };
+    QMap<QString,Word> _words;
+    QHash<const QTextDocument*,QHash<QString,int> > _documentWords;
+    QStringList _library;
+};
+
+#endif // COMPLETIONINDEX_H
@@ -0,0 +1,199 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "convergencechart.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include <algorithm>
+#include <cmath>
+
+static const int maxPreviousRuns = 4;
+
+ConvergenceChart::ConvergenceChart(QWidget *parent) :
+    QWidget(parent), xMax(1000), yMin(0), yMax(1), canvasValid(false)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+QSize ConvergenceChart::sizeHint() const
+{
+    return QSize(300, 200);
+}
+
+void ConvergenceChart::startRun(const QString& m)
+{
+    if (!current.isEmpty()) {
+        QList<Series>& runs = history[model];
+        runs.prepend(current);
+        while (runs.size() > maxPreviousRuns)
+            runs.removeLast();
+    }
+    model = m;
+    current.clear();
+    rescale();
+    canvasValid = false;
+    update();
+}
+
+void ConvergenceChart::clearHistory(void)
+{
+    history.clear();
+    rescale();
+    canvasValid = false;
+    update();
+}
+
+void ConvergenceChart::addPoint(qint64 ms, double objective)
+{
+    QPointF p(ms, objective);
+    current.append(p);
+    // The first point replaces the placeholder text and sets the axes
+    if (!canvasValid || current.size()==1 || !fits(p)) {
+        rescale();
+        canvasValid = false;
+        update();
+        return;
+    }
+    // Only draw the new segment and repaint the area it covers
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(plotRect());
+    painter.setPen(QPen(Qt::blue, 1.5));
+    painter.setBrush(Qt::blue);
+    QPointF to = map(p);
+    QRectF dirty(to, to);
+    if (current.size() > 1) {
+        QPointF from = map(current[current.size()-2]);
+        painter.drawLine(from, to);
+        dirty = QRectF(from, to).normalized();
+    }
+    painter.drawEllipse(to, 2, 2);
+    update(dirty.adjusted(-4,-4,4,4).toAlignedRect());
+}
+
+bool ConvergenceChart::fits(const QPointF& p) const
+{
+    return p.x() <= xMax && p.y() >= yMin && p.y() <= yMax;
+}
+
+void ConvergenceChart::rescale(void)
+{
+    qreal maxX = 0;
+    qreal minY = 0;
+    qreal maxY = 0;
+    bool first = true;
+    QList<Series> all = history.value(model);
+    all.append(current);
+    for (int i=0; i<all.size(); i++) {
+        for (int j=0; j<all[i].size(); j++) {
+            const QPointF& p = all[i][j];
+            maxX = std::max(maxX, p.x());
+            if (first) {
+                minY = maxY = p.y();
+                first = false;
+            } else {
+                minY = std::min(minY, p.y());
+                maxY = std::max(maxY, p.y());
+            }
+        }
+    }
+    // Leave head room on both axes so that most new points fit without a
+    // full redraw: the time axis doubles, the objective axis gets a margin
+    xMax = 1000;
+    while (xMax < maxX*1.1)
+        xMax *= 2;
+    qreal span = maxY-minY;
+    if (span == 0)
+        span = std::max(qreal(1), std::abs(maxY)*0.1);
+    yMin = minY-span*0.25;
+    yMax = maxY+span*0.25;
+}
+
+QRect ConvergenceChart::plotRect(void) const
+{
+    QFontMetrics fm = fontMetrics();
+    int left = std::max(fm.width(QString().number(yMin,'g',6)),
+                        fm.width(QString().number(yMax,'g',6)))+8;
+    return QRect(left, fm.height()/2+4, width()-left-8, height()-2*fm.height()-8);
+}
+
+QPointF ConvergenceChart::map(const QPointF& p) const
+{
+    QRect r = plotRect();
+    return QPointF(r.left()+r.width()*p.x()/xMax,
+                   r.bottom()-r.height()*(p.y()-yMin)/(yMax-yMin));
+}
+
+void ConvergenceChart::drawSeries(QPainter& painter, const Series& s, const QColor& c) const
+{
+    if (s.isEmpty())
+        return;
+    QPolygonF line;
+    for (int i=0; i<s.size(); i++)
+        line.append(map(s[i]));
+    painter.setPen(QPen(c, 1.5));
+    painter.drawPolyline(line);
+    painter.setBrush(c);
+    for (int i=0; i<line.size(); i++)
+        painter.drawEllipse(line[i], 2, 2);
+}
+
+void ConvergenceChart::redraw(void)
+{
+    canvas = QPixmap(size());
+    canvas.fill(palette().color(QPalette::Base));
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QRect r = plotRect();
+    QColor text = palette().color(QPalette::Text);
+    painter.setPen(text);
+    painter.drawRect(r);
+
+    QList<Series> previous = history.value(model);
+    if (current.isEmpty() && previous.isEmpty()) {
+        painter.drawText(r, Qt::AlignCenter, "No objective values yet");
+        canvasValid = true;
+        return;
+    }
+
+    QFontMetrics fm = fontMetrics();
+    painter.drawText(QRect(0, r.top()-fm.height()/2, r.left()-4, fm.height()),
+                     Qt::AlignRight | Qt::AlignVCenter, QString().number(yMax,'g',6));
+    painter.drawText(QRect(0, r.bottom()-fm.height()/2, r.left()-4, fm.height()),
+                     Qt::AlignRight | Qt::AlignVCenter, QString().number(yMin,'g',6));
+    painter.drawText(QRect(r.left(), r.bottom()+2, r.width(), fm.height()),
+                     Qt::AlignLeft | Qt::AlignTop, "0s");
+    painter.drawText(QRect(r.left(), r.bottom()+2, r.width(), fm.height()),
+                     Qt::AlignRight | Qt::AlignTop, QString().number(xMax/1000.0,'g',4)+"s");
+    if (!previous.isEmpty()) {
+        painter.drawText(QRect(r.left(), r.bottom()+2, r.width(), fm.height()),
+                         Qt::AlignHCenter | Qt::AlignTop,
+                         QString().number(previous.size())+(previous.size()==1 ? " previous run" : " previous runs"));
+    }
+
+    painter.setClipRect(r);
+    // Older runs are drawn fainter
+    for (int i=previous.size()-1; i>=0; i--) {
+        QColor c(Qt::gray);
+        c.setAlpha(255-i*150/maxPreviousRuns);
+        drawSeries(painter, previous[i], c);
+    }
+    drawSeries(painter, current, Qt::blue);
+    canvasValid = true;
+}
+
+void ConvergenceChart::paintEvent(QPaintEvent *e)
+{
+    if (!canvasValid)
+        redraw();
+    QPainter painter(this);
+    painter.drawPixmap(e->rect(), canvas, e->rect());
+}
+
+void ConvergenceChart::resizeEvent(QResizeEvent *)
+{
+    canvasValid = false;
+}
@@ -0,0 +1,56 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef CONVERGENCECHART_H
+#define CONVERGENCECHART_H
+
+#include <QWidget>
+#include <QMap>
+#include <QPixmap>
+#include <QVector>
+#include <QPointF>
+
+/// Plots the objective value of each solution against the time it was
+/// found, for the current run and the previous runs of the same model.
+///
+/// The chart is drawn into a pixmap. A new solution only draws the new
+/// segment and repaints its bounding rectangle, unless it is the first
+/// of its run or falls outside the current axis ranges, which triggers a
+/// full redraw.
+class ConvergenceChart : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ConvergenceChart(QWidget *parent = 0);
+    /// Start a new run of \a model, keeping the current run for comparison
+    void startRun(const QString& model);
+    /// Add a solution with objective value \a objective found after \a ms milliseconds
+    void addPoint(qint64 ms, double objective);
+    bool hasPoints(void) const { return !current.isEmpty(); }
+    QSize sizeHint() const;
+public slots:
+    /// Forget all previous runs
+    void clearHistory(void);
+protected:
+    void paintEvent(QPaintEvent *);
+    void resizeEvent(QResizeEvent *);
+private:
+    typedef QVector<QPointF> Series;
+    Series current;
+    QString model;
+    QMap<QString,QList<Series> > history;
+    qreal xMax;
+    qreal yMin;
+    qreal yMax;
+    QPixmap canvas;
+    bool canvasValid;
+    QRect plotRect(void) const;
+    QPointF map(const QPointF& p) const;
+    bool fits(const QPointF& p) const;
+    void rescale(void);
+    void redraw(void);
+    void drawSeries(QPainter& painter, const Series& s, const QColor& c) const;
+};
+
+#endif // CONVERGENCECHART_H
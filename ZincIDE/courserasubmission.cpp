@@ -1,11 +1,11 @@
 #include "courserasubmission.h"
 #include "ui_courserasubmission.h"
 #include "mainwindow.h"
+#include "settings.h"
 
 #include <QCheckBox>
 #include <QVBoxLayout>
 #include <QMessageBox>
-#include <QSettings>
 
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -43,28 +43,24 @@ CourseraSubmission::CourseraSubmission(MainWindow* mw0, CourseraProject& cp) :
         problemLayout->addWidget(new QLabel("none"));
     _output_stream.setString(&_submission);
 
-    QSettings settings;
-    settings.beginGroup("coursera");
-    ui->storePassword->setChecked(settings.value("storeLogin",false).toBool());
-    ui->login->setText(settings.value("login").toString());
-    ui->password->setText(settings.value("password").toString());
-    settings.endGroup();
+    Settings* settings = Settings::instance();
+    ui->storePassword->setChecked(settings->value("coursera/storeLogin",false).toBool());
+    ui->login->setText(settings->value("coursera/login").toString());
+    ui->password->setText(settings->value("coursera/password").toString());
 }
 
 CourseraSubmission::~CourseraSubmission()
 {
-    QSettings settings;
-    settings.beginGroup("coursera");
+    Settings* settings = Settings::instance();
     bool storeLogin = ui->storePassword->isChecked();
-    settings.setValue("storeLogin", storeLogin);
+    settings->setValue("coursera/storeLogin", storeLogin);
     if (storeLogin) {
-        settings.setValue("login",ui->login->text());
-        settings.setValue("password",ui->password->text());
+        settings->setValue("coursera/login",ui->login->text());
+        settings->setValue("coursera/password",ui->password->text());
     } else {
-        settings.setValue("login","");
-        settings.setValue("password","");
+        settings->setValue("coursera/login","");
+        settings->setValue("coursera/password","");
     }
-    settings.endGroup();
     delete ui;
 }
 
@@ -231,7 +227,7 @@ void CourseraSubmission::rcv_challenge()
             connect(mw, SIGNAL(finished()), this, SLOT(solver_finished()));
             ui->textBrowser->insertPlainText("Running "+item.name+"\n");
             _cur_phase = S_WAIT_SOLVE;
-            mw->addOutput("<div style='color:orange;'>Running Coursera submission "+item.name+"</div><br>\n");
+            mw->addMessage("Running Coursera submission "+item.name, OutputConsole::Warning);
             if (!mw->runWithOutput(item.model, item.data, item.timeout, _output_stream)) {
                 ui->textBrowser->insertPlainText("Error: could not run "+item.name+"\n");
                 ui->textBrowser->insertPlainText("Skipping.\n");
@@ -350,11 +346,9 @@ void CourseraSubmission::on_runButton_clicked()
 void CourseraSubmission::on_storePassword_toggled(bool checked)
 {
     if (!checked) {
-        QSettings settings;
-        settings.beginGroup("coursera");
-        settings.setValue("storeLogin", false);
-        settings.setValue("login","");
-        settings.setValue("password","");
-        settings.endGroup();
+        Settings* settings = Settings::instance();
+        settings->setValue("coursera/storeLogin", false);
+        settings->setValue("coursera/login","");
+        settings->setValue("coursera/password","");
     }
 }
@@ -0,0 +1,100 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "diagnosticparser.h"
+
+QString DiagnosticParser::Diagnostic::location(void) const
+{
+    QString l = file+":"+QString().number(line)+":";
+    if (col > 0)
+        l += QString().number(col)+":";
+    return l;
+}
+
+QStringList DiagnosticParser::lines(const QString& chunk)
+{
+    QStringList result;
+    int start = 0;
+    for (;;) {
+        int nl = chunk.indexOf('\n', start);
+        if (nl == -1)
+            break;
+        QString l = chunk.mid(start, nl-start);
+        if (start == 0 && !_partial.isEmpty()) {
+            l.prepend(_partial);
+            _partial.clear();
+        }
+        if (l.endsWith('\r'))
+            l.chop(1);
+        result.append(l);
+        start = nl+1;
+    }
+    _partial += chunk.mid(start);
+    return result;
+}
+
+QString DiagnosticParser::rest(void)
+{
+    QString r = _partial;
+    _partial.clear();
+    if (r.endsWith('\r'))
+        r.chop(1);
+    return r;
+}
+
+namespace {
+    /// Parse the decimal number starting at \a i, advancing \a i past it
+    int number(const QString& s, int& i)
+    {
+        int n = 0;
+        while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+            n = n*10+(s[i].unicode()-'0');
+            i++;
+        }
+        return n;
+    }
+}
+
+bool DiagnosticParser::parse(const QString& line, Diagnostic& d)
+{
+    // The file name ends at the first colon that is followed by a line
+    // number and another colon, which skips Windows drive letters
+    for (int i = line.indexOf(':'); i > 0; i = line.indexOf(':', i+1)) {
+        int j = i+1;
+        int lineNo = number(line, j);
+        if (j == i+1 || j >= line.size() || line[j] != ':')
+            continue;
+        QString file = line.left(i).trimmed();
+        // Only accept file names with an extension, so that e.g. times
+        // ("elapsed: 10:02:") are not taken for locations
+        int ext = file.lastIndexOf('.');
+        if (ext == -1 || ext < file.lastIndexOf('/') || ext < file.lastIndexOf('\\'))
+            continue;
+        int k = j+1;
+        int col = number(line, k);
+        int msgStart = j+1;
+        if (k > j+1 && k < line.size() && line[k] == ':') {
+            msgStart = k+1;
+        } else {
+            col = 0;
+        }
+        d.file = file;
+        d.line = lineNo;
+        d.col = col;
+        d.message = line.mid(msgStart).trimmed();
+        d.severity = severity(d.message);
+        return true;
+    }
+    return false;
+}
+
+DiagnosticParser::Severity DiagnosticParser::severity(const QString& message)
+{
+    if (message.startsWith("warning", Qt::CaseInsensitive))
+        return Warning;
+    if (message.startsWith("note", Qt::CaseInsensitive) ||
+            message.startsWith("info", Qt::CaseInsensitive))
+        return Note;
+    return Error;
+}
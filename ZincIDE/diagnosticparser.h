@@ -0,0 +1,50 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DIAGNOSTICPARSER_H
+#define DIAGNOSTICPARSER_H
+
+#include <QString>
+#include <QStringList>
+
+/// Splits the output of the compiler or a solver into lines and recognises
+/// diagnostics of the form "file:line:col: message" or "file:line: message".
+///
+/// Output arrives in arbitrary chunks, so each stream gets its own parser,
+/// which keeps a partial last line until the rest of it has been read.
+/// Locations are recognised by a single scan of the line.
+class DiagnosticParser
+{
+public:
+    enum Severity { Error=0, Warning, Note };
+
+    struct Diagnostic {
+        QString file;
+        /// 1-based line, as reported
+        int line;
+        /// 1-based column, or 0 if none was reported
+        int col;
+        Severity severity;
+        QString message;
+        Diagnostic(void) : line(0), col(0), severity(Error) {}
+        /// The "file:line:col:" prefix, as shown in the output
+        QString location(void) const;
+    };
+
+    /// Add \a chunk to the buffer and return the lines it completes, without line breaks
+    QStringList lines(const QString& chunk);
+    /// Return the partial line left in the buffer, e.g. once the process has finished
+    QString rest(void);
+    void clear(void) { _partial.clear(); }
+
+    /// Parse \a line as a diagnostic. The message may be empty if it
+    /// follows on the next lines.
+    static bool parse(const QString& line, Diagnostic& d);
+    /// The severity implied by the start of \a message ("warning", "note", ...)
+    static Severity severity(const QString& message);
+private:
+    QString _partial;
+};
+
+#endif // DIAGNOSTICPARSER_H
@@ -0,0 +1,135 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "documentexporter.h"
+#include "rtfexporter.h"
+#include "tokenizer.h"
+
+#include <QFile>
+#include <QFontMetricsF>
+#include <QPainter>
+#include <QPdfWriter>
+
+#include <algorithm>
+
+DocumentExporter::DocumentExporter(const QString& text, const QVector<QTextCharFormat>& formats,
+                                   const QFont& font, const QString& title,
+                                   const QString& fileName, Format format, QObject *parent)
+    : QThread(parent), _text(text), _formats(formats), _font(font), _title(title),
+      _fileName(fileName), _format(format)
+{
+}
+
+DocumentExporter::~DocumentExporter(void)
+{
+    // Closing the window during an export must not destroy the running thread
+    wait();
+}
+
+void DocumentExporter::run()
+{
+    bool ok;
+    if (_format==PDF) {
+        ok = exportPdf();
+    } else {
+        RtfExporter exporter(_font);
+        exporter.exportText(_text, _formats);
+        QFile f(_fileName);
+        ok = f.open(QFile::WriteOnly | QFile::Truncate);
+        if (ok) {
+            QByteArray data = _format==HTML ? exporter.html() : exporter.rtf();
+            ok = f.write(data)==data.size();
+        }
+    }
+    emit exported(ok, _fileName);
+}
+
+namespace {
+    /// Lays out monospaced text on the pages of a PDF, wrapping long lines
+    class PdfPages {
+    public:
+        PdfPages(QPdfWriter& writer, QPainter& painter, const QFont& font)
+            : _writer(writer), _painter(painter), _font(font), _row(0), _col(0)
+        {
+            QFontMetricsF fm(font, &writer);
+            _lineHeight = fm.lineSpacing();
+            _ascent = fm.ascent();
+            _charWidth = fm.width('M');
+            _columns = std::max(1, static_cast<int>(writer.width()/_charWidth));
+            _rows = std::max(1, static_cast<int>(writer.height()/_lineHeight));
+        }
+        void draw(const QString& line, int from, int to, const QTextCharFormat& format)
+        {
+            if (from >= to)
+                return;
+            QFont f = _font;
+            f.setBold(format.fontWeight() > QFont::Normal);
+            f.setItalic(format.fontItalic());
+            _painter.setFont(f);
+            _painter.setPen(format.hasProperty(QTextFormat::ForegroundBrush) ?
+                                format.foreground().color() : QColor(Qt::black));
+            while (from < to) {
+                if (_col == _columns)
+                    newRow();
+                int n = std::min(to-from, _columns-_col);
+                _painter.drawText(QPointF(_col*_charWidth, _row*_lineHeight+_ascent), line.mid(from, n));
+                _col += n;
+                from += n;
+            }
+        }
+        void newRow(void)
+        {
+            _col = 0;
+            if (++_row == _rows) {
+                _writer.newPage();
+                _row = 0;
+            }
+        }
+    private:
+        QPdfWriter& _writer;
+        QPainter& _painter;
+        QFont _font;
+        qreal _lineHeight;
+        qreal _ascent;
+        qreal _charWidth;
+        int _columns;
+        int _rows;
+        int _row;
+        int _col;
+    };
+}
+
+bool DocumentExporter::exportPdf(void)
+{
+    QPdfWriter writer(_fileName);
+    writer.setTitle(_title);
+    writer.setPageSize(QPagedPaintDevice::A4);
+    writer.setPageMargins(QMarginsF(15, 15, 15, 15), QPageLayout::Millimeter);
+    QPainter painter;
+    if (!painter.begin(&writer))
+        return false;
+    PdfPages pages(writer, painter, _font);
+    QVector<Tokenizer::Token> tokens;
+    bool inComment = false;
+    int start = 0;
+    for (;;) {
+        int nl = _text.indexOf('\n', start);
+        QString line = _text.mid(start, (nl==-1 ? _text.size() : nl)-start);
+        line.replace('\t', "  ");
+        tokens.clear();
+        inComment = Tokenizer::tokenize(line, inComment, tokens);
+        int pos = 0;
+        for (int i=0; i<tokens.size(); i++) {
+            pages.draw(line, pos, tokens[i].start, _formats[Tokenizer::Plain]);
+            pages.draw(line, tokens[i].start, tokens[i].start+tokens[i].length, _formats[tokens[i].cls]);
+            pos = tokens[i].start+tokens[i].length;
+        }
+        pages.draw(line, pos, line.size(), _formats[Tokenizer::Plain]);
+        if (nl == -1)
+            break;
+        pages.newRow();
+        start = nl+1;
+    }
+    return painter.end();
+}
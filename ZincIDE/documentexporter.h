@@ -0,0 +1,41 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DOCUMENTEXPORTER_H
+#define DOCUMENTEXPORTER_H
+
+#include <QThread>
+#include <QFont>
+#include <QTextCharFormat>
+#include <QVector>
+
+/// Exports a snapshot of a document with syntax highlighting to an HTML,
+/// RTF or PDF file, in a background thread.
+class DocumentExporter : public QThread
+{
+    Q_OBJECT
+public:
+    enum Format { HTML, RTF, PDF };
+    /// Export \a text to \a fileName, highlighted using \a formats
+    /// (see Highlighter::tokenFormats)
+    DocumentExporter(const QString& text, const QVector<QTextCharFormat>& formats,
+                     const QFont& font, const QString& title,
+                     const QString& fileName, Format format, QObject *parent = 0);
+    /// Waits for an export that is still running to finish
+    ~DocumentExporter(void);
+signals:
+    void exported(bool ok, const QString& fileName);
+protected:
+    void run();
+private:
+    QString _text;
+    QVector<QTextCharFormat> _formats;
+    QFont _font;
+    QString _title;
+    QString _fileName;
+    Format _format;
+    bool exportPdf(void);
+};
+
+#endif // DOCUMENTEXPORTER_H
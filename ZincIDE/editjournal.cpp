@@ -0,0 +1,349 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "editjournal.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QUuid>
+
+static const quint32 journalMagic = 0x4d4a524e;
+static const quint32 journalVersion = 1;
+
+/// A journal is compacted into a snapshot after this many changes
+static const int compactAfter = 2000;
+
+namespace {
+    enum Base { BaseFile, BaseSnapshot };
+
+    struct OpenJournal {
+        QFile* file;
+        int changes;
+        OpenJournal(QFile* f=NULL) : file(f), changes(0) {}
+    };
+
+    QFile* openForAppend(const QString& fileName)
+    {
+        QFile* f = new QFile(fileName);
+        if (!f->open(QFile::WriteOnly | QFile::Append)) {
+            delete f;
+            return NULL;
+        }
+        return f;
+    }
+
+    void closeJournal(QHash<QString,OpenJournal>& journals, const QString& path)
+    {
+        QHash<QString,OpenJournal>::iterator j = journals.find(path);
+        if (j != journals.end()) {
+            delete j.value().file;
+            journals.erase(j);
+        }
+    }
+}
+
+EditJournal::EditJournal(QObject *parent)
+    : QThread(parent), _stop(false)
+{
+    _dir = journalRoot()+"/"+QUuid::createUuid().toString().mid(1, 36);
+    QDir().mkpath(journalRoot());
+    _lock = new QLockFile(_dir+".lock");
+    _lock->setStaleLockTime(0);
+    _lock->tryLock(0);
+    start(QThread::LowPriority);
+}
+
+EditJournal::~EditJournal(void)
+{
+    {
+        QMutexLocker lock(&_mutex);
+        _stop = true;
+        _wake.wakeOne();
+    }
+    wait();
+    // Edits that were neither saved nor discarded by now are discarded
+    QDir(_dir).removeRecursively();
+    delete _lock;
+}
+
+void EditJournal::watch(QTextDocument* doc, const QString& path)
+{
+    _paths[doc] = path;
+    connect(doc, SIGNAL(contentsChange(int,int,int)), this, SLOT(contentsChange(int,int,int)));
+    connect(doc, SIGNAL(modificationChanged(bool)), this, SLOT(modificationChanged(bool)));
+}
+
+void EditJournal::unwatch(QTextDocument* doc)
+{
+    disconnect(doc, 0, this, 0);
+    if (_journaled.remove(doc))
+        enqueue(Record::Discard, _paths.value(doc));
+    _paths.remove(doc);
+}
+
+void EditJournal::rename(QTextDocument* doc, const QString& path)
+{
+    QHash<QTextDocument*,QString>::iterator p = _paths.find(doc);
+    if (p == _paths.end() || p.value() == path)
+        return;
+    if (_journaled.remove(doc))
+        enqueue(Record::Discard, p.value());
+    p.value() = path;
+    if (doc->isModified())
+        snapshot(doc);
+}
+
+void EditJournal::snapshot(QTextDocument* doc)
+{
+    QHash<QTextDocument*,QString>::const_iterator p = _paths.find(doc);
+    if (p == _paths.end())
+        return;
+    enqueue(Record::Snapshot, p.value(), 0, 0, doc->toPlainText());
+    _journaled.insert(doc);
+}
+
+void EditJournal::contentsChange(int position, int charsRemoved, int charsAdded)
+{
+    QTextDocument* doc = static_cast<QTextDocument*>(sender());
+    QHash<QTextDocument*,QString>::const_iterator p = _paths.find(doc);
+    if (p == _paths.end())
+        return;
+    // Until the first change the document has the text of its file
+    if (!_journaled.contains(doc)) {
+        enqueue(Record::Open, p.value());
+        _journaled.insert(doc);
+    }
+    QString text;
+    if (charsAdded > 0) {
+        // The counts can include the paragraph separator at the end,
+        // which is not part of the plain text
+        QTextCursor cursor(doc);
+        cursor.setPosition(position);
+        cursor.setPosition(qMin(position+charsAdded, doc->characterCount()-1), QTextCursor::KeepAnchor);
+        text = cursor.selectedText();
+        text.replace(QChar::ParagraphSeparator, '\n');
+    }
+    enqueue(Record::Change, p.value(), position, charsRemoved, text);
+}
+
+void EditJournal::modificationChanged(bool modified)
+{
+    if (modified)
+        return;
+    // Saved, or undone back to the text of the file
+    QTextDocument* doc = static_cast<QTextDocument*>(sender());
+    if (_journaled.remove(doc))
+        enqueue(Record::Discard, _paths.value(doc));
+}
+
+void EditJournal::enqueue(Record::Type type, const QString& path, int position, int removed, const QString& text)
+{
+    Record r;
+    r.type = type;
+    r.path = path;
+    r.position = position;
+    r.removed = removed;
+    r.text = text;
+    QMutexLocker lock(&_mutex);
+    _queue.append(r);
+    if (_queue.size()==1)
+        _wake.wakeOne();
+}
+
+void EditJournal::run(void)
+{
+    QDir().mkpath(_dir);
+    QHash<QString,OpenJournal> journals;
+    for (;;) {
+        QList<Record> batch;
+        {
+            QMutexLocker lock(&_mutex);
+            while (_queue.isEmpty() && !_stop)
+                _wake.wait(&_mutex);
+            if (_queue.isEmpty())
+                break;
+            batch.swap(_queue);
+        }
+        QSet<QString> written;
+        for (int i=0; i<batch.size(); i++) {
+            const Record& r = batch[i];
+            QString fileName = journalFile(r.path);
+            switch (r.type) {
+            case Record::Open:
+            {
+                closeJournal(journals, r.path);
+                QFile* f = new QFile(fileName);
+                if (!f->open(QFile::WriteOnly | QFile::Truncate)) {
+                    delete f;
+                    break;
+                }
+                QFileInfo fi(r.path);
+                QDataStream out(f);
+                out << journalMagic << journalVersion << r.path << quint8(BaseFile)
+                    << qint64(fi.size()) << qint64(fi.lastModified().toMSecsSinceEpoch());
+                journals.insert(r.path, OpenJournal(f));
+                written.insert(r.path);
+                break;
+            }
+            case Record::Snapshot:
+            {
+                closeJournal(journals, r.path);
+                if (writeSnapshot(fileName, r.path, r.text)) {
+                    QFile* f = openForAppend(fileName);
+                    if (f)
+                        journals.insert(r.path, OpenJournal(f));
+                }
+                break;
+            }
+            case Record::Change:
+            {
+                QHash<QString,OpenJournal>::iterator j = journals.find(r.path);
+                if (j == journals.end())
+                    break;
+                QDataStream out(j.value().file);
+                out << quint8(Record::Change) << qint32(r.position) << qint32(r.removed) << r.text;
+                written.insert(r.path);
+                if (++j.value().changes < compactAfter)
+                    break;
+                // Replace the changes by the text they produce
+                closeJournal(journals, r.path);
+                written.remove(r.path);
+                QString path, text;
+                if (replay(fileName, path, text) && writeSnapshot(fileName, path, text)) {
+                    QFile* f = openForAppend(fileName);
+                    if (f)
+                        journals.insert(r.path, OpenJournal(f));
+                } else {
+                    // The file changed underneath the journal, which
+                    // therefore cannot be replayed any more
+                    QFile::remove(fileName);
+                }
+                break;
+            }
+            case Record::Discard:
+                closeJournal(journals, r.path);
+                QFile::remove(fileName);
+                break;
+            }
+        }
+        for (QSet<QString>::const_iterator it = written.begin(); it != written.end(); ++it) {
+            QHash<QString,OpenJournal>::iterator j = journals.find(*it);
+            if (j != journals.end())
+                j.value().file->flush();
+        }
+    }
+    for (QHash<QString,OpenJournal>::iterator j = journals.begin(); j != journals.end(); ++j)
+        delete j.value().file;
+}
+
+QString EditJournal::journalFile(const QString& path) const
+{
+    return _dir+"/"+QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex()+".journal";
+}
+
+QString EditJournal::journalRoot(void)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation)+"/journal";
+}
+
+QStringList EditJournal::abandonedSessions(void)
+{
+    QStringList result;
+    QDir root(journalRoot());
+    QStringList dirs = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (int i=0; i<dirs.size(); i++) {
+        QLockFile lock(root.absoluteFilePath(dirs[i])+".lock");
+        lock.setStaleLockTime(0);
+        // The lock of a session that crashed is stale
+        if (lock.tryLock(0)) {
+            result.append(root.absoluteFilePath(dirs[i]));
+            lock.unlock();
+        }
+    }
+    return result;
+}
+
+QMap<QString,QString> EditJournal::recover(void)
+{
+    QMap<QString,QString> result;
+    QStringList sessions = abandonedSessions();
+    for (int i=0; i<sessions.size(); i++) {
+        QDir dir(sessions[i]);
+        QStringList files = dir.entryList(QStringList("*.journal"), QDir::Files, QDir::Time | QDir::Reversed);
+        for (int j=0; j<files.size(); j++) {
+            QString path, text;
+            if (replay(dir.absoluteFilePath(files[j]), path, text))
+                result.insert(path, text);
+        }
+    }
+    return result;
+}
+
+void EditJournal::removeJournals(void)
+{
+    QStringList sessions = abandonedSessions();
+    for (int i=0; i<sessions.size(); i++)
+        QDir(sessions[i]).removeRecursively();
+}
+
+bool EditJournal::writeSnapshot(const QString& fileName, const QString& path, const QString& text)
+{
+    QSaveFile f(fileName);
+    if (!f.open(QFile::WriteOnly))
+        return false;
+    QDataStream out(&f);
+    out << journalMagic << journalVersion << path << quint8(BaseSnapshot) << text;
+    return f.commit();
+}
+
+bool EditJournal::replay(const QString& fileName, QString& path, QString& text)
+{
+    QFile f(fileName);
+    if (!f.open(QFile::ReadOnly))
+        return false;
+    QDataStream in(&f);
+    quint32 magic, version;
+    quint8 base;
+    in >> magic >> version;
+    if (magic != journalMagic || version != journalVersion)
+        return false;
+    in >> path >> base;
+    if (base==BaseFile) {
+        qint64 size, mtime;
+        in >> size >> mtime;
+        QFile file(path);
+        QFileInfo fi(path);
+        if (fi.size() != size || fi.lastModified().toMSecsSinceEpoch() != mtime ||
+                !file.open(QFile::ReadOnly | QFile::Text))
+            return false;
+        text = QString::fromUtf8(file.readAll());
+    } else {
+        in >> text;
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+    for (;;) {
+        quint8 type;
+        qint32 position, removed;
+        QString added;
+        in >> type >> position >> removed >> added;
+        // A record cut short by a crash ends the journal
+        if (in.status() != QDataStream::Ok || type != Record::Change)
+            break;
+        if (position > text.size())
+            position = text.size();
+        text.remove(position, removed);
+        text.insert(position, added);
+    }
+    return true;
+}
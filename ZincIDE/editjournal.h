@@ -0,0 +1,88 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+class QLockFile;
+class QTextDocument;
+
+/// Journal of the unsaved edits to the open documents, so they can be
+/// restored after a crash.
+///
+/// Each modified document has an append-only journal file that starts
+/// from the contents of the file on disk and records every change to the
+/// text. The GUI thread only queues the changes; a background thread
+/// writes them and, once a journal holds many changes, compacts it into
+/// a snapshot of the text. A journal is removed when its document is
+/// saved, reloaded or closed.
+///
+/// The journals of a session are kept in a directory of their own, next
+/// to a lock file held while the session runs. The journals of sessions
+/// whose lock has been abandoned are the ones to recover.
+class EditJournal : public QThread
+{
+    Q_OBJECT
+public:
+    explicit EditJournal(QObject *parent = 0);
+    ~EditJournal(void);
+    /// Record the changes to \a doc, whose text is that of the file \a path
+    void watch(QTextDocument* doc, const QString& path);
+    /// Stop recording the changes to \a doc and remove its journal
+    void unwatch(QTextDocument* doc);
+    /// The file of \a doc has been renamed to \a path
+    void rename(QTextDocument* doc, const QString& path);
+    /// The text of \a doc no longer is that of its file, so record all of it
+    void snapshot(QTextDocument* doc);
+
+    /// The texts recorded in the journals left behind by sessions that
+    /// did not shut down properly, by file name
+    static QMap<QString,QString> recover(void);
+    /// Remove the journals left behind by sessions that did not shut down properly
+    static void removeJournals(void);
+protected:
+    void run(void);
+private slots:
+    void contentsChange(int position, int charsRemoved, int charsAdded);
+    void modificationChanged(bool modified);
+private:
+    struct Record {
+        enum Type { Open, Snapshot, Change, Discard };
+        Type type;
+        QString path;
+        int position;
+        int removed;
+        QString text;
+    };
+    /// Owned by the GUI thread
+    QHash<QTextDocument*,QString> _paths;
+    QSet<QTextDocument*> _journaled;
+    /// Shared with the writer thread
+    QMutex _mutex;
+    QWaitCondition _wake;
+    QList<Record> _queue;
+    bool _stop;
+    /// Directory of the journals of this session
+    QString _dir;
+    QLockFile* _lock;
+    void enqueue(Record::Type type, const QString& path,
+                 int position = 0, int removed = 0, const QString& text = QString());
+
+    QString journalFile(const QString& path) const;
+    static QString journalRoot(void);
+    static QStringList abandonedSessions(void);
+    static bool writeSnapshot(const QString& fileName, const QString& path, const QString& text);
+    static bool replay(const QString& fileName, QString& path, QString& text);
+};
+
+#endif // EDITJOURNAL_H
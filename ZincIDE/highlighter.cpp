@@ -13,205 +13,209 @@
 #include <QDebug>
 
 #include "highlighter.h"
+#include "trace.h"
+#include "rtfexporter.h"
+#include "completionindex.h"
 
-
-Highlighter::Highlighter(QFont& font, bool dm, QTextDocument *parent)
-    : QSyntaxHighlighter(parent)
+BracketData::~BracketData(void)
 {
-    Rule rule;
-
-    quoteFormat.setForeground(Qt::darkRed);
-    rule.pattern = QRegExp("\"([^\"\\\\]|\\\\.)*\"");
-    rule.format = quoteFormat;
-    rules.append(rule);
-
-    commentFormat.setForeground(Qt::red);
-    rule.pattern = QRegExp("%[^\n]*");
-    rule.format = commentFormat;
-    rules.append(rule);
-
-    QStringList patterns;
-    patterns << "\\bann\\b" << "\\bannotation\\b" << "\\bany\\b"
-             << "\\barray\\b" << "\\bbool\\b" << "\\bcase\\b"
-             << "\\bconstraint\\b" << "\\bdefault\\b" << "\\bdiv\\b"
-             << "\\bdiff\\b" << "\\belse\\b" << "\\belseif\\b"
-             << "\\bendif\\b" << "\\benum\\b" << "\\bfloat\\b"
-             << "\\bfunction\\b" << "\\bif\\b" << "\\binclude\\b"
-             << "\\bintersect\\b" << "\\bin\\b" << "\\bint\\b"
-             << "\\blet\\b" << "\\bmaximize\\b" << "\\bminimize\\b"
-             << "\\bmod\\b" << "\\bnot\\b" << "\\bof\\b" << "\\boutput\\b"
-             << "\\bopt\\b" << "\\bpar\\b" << "\\bpredicate\\b"
-             << "\\brecord\\b" << "\\bsatisfy\\b" << "\\bset\\b"
-             << "\\bsolve\\b" << "\\bstring\\b" << "\\bsubset\\b"
-             << "\\bsuperset\\b" << "\\bsymdiff\\b" << "\\btest\\b"
-             << "\\bthen\\b" << "\\btuple\\b" << "\\btype\\b"
-             << "\\bunion\\b" << "\\bvar\\b" << "\\bvariant_record\\b"
-             << "\\bwhere\\b" << "\\bxor\\b";
-    QTextCharFormat format;
-
-    format.setFontWeight(QFont::Bold);
-    for (int i=0; i<patterns.size(); i++) {
-        rule.pattern = QRegExp(patterns[i]);
-        rule.format = format;
-        rules.append(rule);
-    }
-
-    format = QTextCharFormat();
-    format.setFontItalic(true);
-    format.setForeground(Qt::blue);
-    rule.pattern = QRegExp("\\b[A-Za-z0-9_]+(?=\\s*\\()");
-    rule.format = format;
-    rules.append(rule);
+    CompletionIndex::instance()->removeWords(doc, words);
+}
 
-    setEditorFont(font);
 
-    commentStartExp = QRegExp("/\\*");
-    commentEndExp = QRegExp("\\*/");
+Highlighter::Highlighter(bool dm, QTextDocument *parent)
+    : QSyntaxHighlighter(parent), formats(Tokenizer::NumClasses), palette(0), released(false)
+{
+    // The formats do not set a font, so each editor renders them in the
+    // document's font
+    formats[Tokenizer::Keyword].setFontWeight(QFont::Bold);
+    formats[Tokenizer::Function].setFontItalic(true);
 
     setDarkMode(dm);
-
 }
 
-void Highlighter::setEditorFont(QFont& font)
+Highlighter* Highlighter::forDocument(QTextDocument* doc, bool darkMode)
 {
-    quoteFormat.setFont(font);
-    commentFormat.setFont(font);
-    for (int i=0; i<rules.size(); i++) {
-        rules[i].format.setFont(font);
-    }
+    Highlighter* h = doc->findChild<Highlighter*>(QString(), Qt::FindDirectChildrenOnly);
+    if (h==NULL)
+        h = new Highlighter(darkMode, doc);
+    return h;
 }
 
 void Highlighter::highlightBlock(const QString &text)
 {
-    for (int i=0; i<rules.size(); i++) {
-        const Rule& rule = rules[i];
-        QRegExp expression(rule.pattern);
-        int index = expression.indexIn(text);
-        while (index >= 0) {
-            int length = expression.matchedLength();
-            if (format(index)!=quoteFormat && format(index)!=commentFormat) {
-                setFormat(index, length, rule.format);
+    TRACE_SPAN("Highlighter::highlightBlock");
+    // Only the beginning of very long blocks (typically generated data) is
+    // scanned, so that editing them stays fast. The next block starts in
+    // the state the scan ends in, so a block comment opened or closed past
+    // the limit is not seen, and neither are the brackets there.
+    bool longBlock = text.size() > longBlockLength;
+    QString scanned = longBlock ? QString::fromRawData(text.constData(), longBlockLength) : text;
+    QVector<Tokenizer::Token> tokens;
+    bool inComment = Tokenizer::tokenize(scanned, previousBlockState()==1, tokens);
+    BracketData* bd = new BracketData(document());
+    for (int i=0; i<tokens.size(); i++) {
+        setFormat(tokens[i].start, tokens[i].length, formats[tokens[i].cls]);
+        bd->tokens.append(tokens[i]);
+    }
+    bd->palette = palette;
+
+    // Record all brackets outside of strings and comments
+    QVector<int> open;
+    int t = 0;
+    const QChar* s = scanned.constData();
+    const int n = scanned.size();
+    for (int pos=0; pos<n; pos++) {
+        ushort c = s[pos].unicode();
+        if (c=='(' || c==')' || c=='{' || c=='}' || c=='[' || c==']') {
+            while (t < tokens.size() && tokens[t].start+tokens[t].length <= pos)
+                t++;
+            bool quoted = t < tokens.size() && tokens[t].start <= pos &&
+                          (tokens[t].cls==Tokenizer::String || tokens[t].cls==Tokenizer::Comment);
+            if (!quoted) {
+                Bracket b;
+                b.b = c;
+                b.pos = pos;
+                if (c=='(' || c=='{' || c=='[') {
+                    open.append(bd->brackets.size());
+                    bd->depthChange++;
+                } else {
+                    if (!open.isEmpty())
+                        open.pop_back();
+                    bd->depthChange--;
+                }
+                bd->brackets.append(b);
             }
-            index = expression.indexIn(text, index + length);
         }
     }
-
-    BracketData* bd = new BracketData;
-    QRegExp re("\\(|\\)|\\{|\\}|\\[|\\]");
-    int pos = text.indexOf(re);
-    while (pos != -1) {
-        if (format(pos)!=quoteFormat && format(pos)!=commentFormat) {
-            Bracket b;
-            b.b = text.at(pos);
-            b.pos = pos;
-            bd->brackets.append(b);
+    if (!open.isEmpty())
+        bd->foldOpen = open.first();
+
+    // Conditionals nest like brackets, and a line starting with closing
+    // brackets or a conditional keyword is outdented
+    int first = 0;
+    while (first < n && s[first].isSpace())
+        first++;
+    for (int i=0; i<tokens.size(); i++) {
+        // A keyword followed by a parenthesis is classified as a function
+        if (tokens[i].cls != Tokenizer::Keyword && tokens[i].cls != Tokenizer::Function)
+            continue;
+        QString kw = QString::fromRawData(s+tokens[i].start, tokens[i].length);
+        if (kw=="if") {
+            bd->depthChange++;
+        } else if (kw=="endif") {
+            bd->depthChange--;
         }
-        pos = text.indexOf(re, pos+1);
+        if (tokens[i].start==first && (kw=="then" || kw=="else" || kw=="elseif" || kw=="endif"))
+            bd->dedent = 1;
     }
-    setCurrentBlockUserData(bd);
-    setCurrentBlockState(0);
-
-    int commentStartIndex = 0;
-    if (previousBlockState() != 1) {
-        commentStartIndex = commentStartExp.indexIn(text);
+    if (bd->dedent==0) {
+        for (int i=first; i<n; i++) {
+            if (s[i]==')' || s[i]=='}' || s[i]==']') {
+                bd->dedent++;
+            } else if (!s[i].isSpace()) {
+                break;
+            }
+        }
     }
-    while (commentStartIndex >= 0) {
-        int commentEndIndex = commentEndExp.indexIn(text, commentStartIndex);
-        int commentLength;
-        if (commentEndIndex == -1) {
-            setCurrentBlockState(1);
-            commentLength = text.length() - commentStartIndex;
-        } else {
-            commentLength = commentEndIndex - commentStartIndex + commentEndExp.matchedLength();
+    // Collect the words outside of strings and comments for completion
+    t = 0;
+    for (int pos=0; pos<n; ) {
+        while (t < tokens.size() && tokens[t].start+tokens[t].length <= pos)
+            t++;
+        if (t < tokens.size() && tokens[t].start <= pos &&
+                (tokens[t].cls==Tokenizer::String || tokens[t].cls==Tokenizer::Comment)) {
+            pos = tokens[t].start+tokens[t].length;
+            continue;
         }
-        setFormat(commentStartIndex, commentLength, commentFormat);
-        commentStartIndex = commentStartExp.indexIn(text, commentStartIndex + commentLength);
+        if (!Tokenizer::isWordChar(s[pos])) {
+            pos++;
+            continue;
+        }
+        int start = pos;
+        while (pos < n && Tokenizer::isWordChar(s[pos]))
+            pos++;
+        if (s[start].isLetter())
+            bd->words.append(scanned.mid(start, pos-start));
     }
+    CompletionIndex::instance()->addWords(document(), bd->words);
+
+    if (longBlock)
+        emit longBlockHighlighted();
+    setCurrentBlockUserData(bd);
+    setCurrentBlockState(inComment ? 1 : 0);
 }
 
-#include <QTextCursor>
-#include <QTextDocumentFragment>
-#include <QTextLayout>
-#include <QTextEdit>
 #include <QApplication>
 #include <QClipboard>
-#include <QMimeData>
-
-class MyMimeDataExporter : public QTextEdit {
-public:
-    QMimeData* md(void) const {
-        QMimeData* mymd = createMimeDataFromSelection();
-        mymd->removeFormat("text/plain");
-        return mymd;
-    }
-};
 
-void Highlighter::copyHighlightedToClipboard(QTextCursor cursor)
+void Highlighter::refreshFormats(const QTextBlock& block)
 {
-    QTextDocument* tempDocument(new QTextDocument);
-    Q_ASSERT(tempDocument);
-    QTextCursor tempCursor(tempDocument);
+    BracketData* bd = static_cast<BracketData*>(block.userData());
+    if (bd==NULL || bd->palette==palette)
+        return;
+    QList<QTextLayout::FormatRange> ranges;
+    for (int i=0; i<bd->tokens.size(); i++) {
+        QTextLayout::FormatRange r;
+        r.start = bd->tokens[i].start;
+        r.length = bd->tokens[i].length;
+        r.format = formats[bd->tokens[i].cls];
+        ranges.append(r);
+    }
+    block.layout()->setAdditionalFormats(ranges);
+    bd->palette = palette;
+    // Only lays out this block again, without highlighting it
+    document()->markContentsDirty(block.position(), block.length());
+}
 
-    tempCursor.insertFragment(cursor.selection());
-    tempCursor.select(QTextCursor::Document);
+void Highlighter::release(void)
+{
+    if (released)
+        return;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        // Also removes the words of the block from the CompletionIndex
+        block.setUserData(NULL);
+        block.layout()->clearAdditionalFormats();
+        // The layout is created again when the block is shown
+        block.layout()->clearLayout();
+    }
+    released = true;
+}
 
-    QTextCharFormat textfmt = cursor.charFormat();
-    textfmt.setFont(quoteFormat.font());
-    tempCursor.setCharFormat(textfmt);
+void Highlighter::restore(void)
+{
+    if (!released)
+        return;
+    released = false;
+    rehighlight();
+}
 
-    QTextBlock start = document()->findBlock(cursor.selectionStart());
+void Highlighter::copyHighlightedToClipboard(QTextCursor cursor)
+{
     QTextBlock end = document()->findBlock(cursor.selectionEnd());
-    end = end.next();
-    const int selectionStart = cursor.selectionStart();
-    const int endOfDocument = tempDocument->characterCount() - 1;
-    for(QTextBlock current = start; current.isValid() && current != end; current = current.next()) {
-        const QTextLayout* layout(current.layout());
-
-        foreach(const QTextLayout::FormatRange &range, layout->additionalFormats()) {
-            const int start = current.position() + range.start - selectionStart;
-            const int end = start + range.length;
-            if(end <= 0 || start >= endOfDocument)
-                continue;
-            tempCursor.setPosition(qMax(start, 0));
-            tempCursor.setPosition(qMin(end, endOfDocument), QTextCursor::KeepAnchor);
-            tempCursor.setCharFormat(range.format);
-        }
+    for (QTextBlock b = document()->findBlock(cursor.selectionStart()); b.isValid(); b = b.next()) {
+        refreshFormats(b);
+        if (b == end)
+            break;
     }
-
-    for(QTextBlock block = tempDocument->begin(); block.isValid(); block = block.next())
-        block.setUserState(-1);
-
-    tempCursor.select(QTextCursor::Document);
-    QTextBlockFormat blockFormat = cursor.blockFormat();
-    blockFormat.setNonBreakableLines(true);
-    tempCursor.setBlockFormat(blockFormat);
-
-    MyMimeDataExporter te;
-    te.setDocument(tempDocument);
-    te.selectAll();
-    QMimeData* mimeData = te.md();
-    QApplication::clipboard()->setMimeData(mimeData);
-    delete tempDocument;
+    RtfExporter exporter(document()->defaultFont());
+    exporter.exportRange(document(), cursor.selectionStart(), cursor.selectionEnd());
+    QApplication::clipboard()->setMimeData(exporter.mimeData());
 }
 
 void Highlighter::setDarkMode(bool enable)
 {
     darkMode = enable;
+    palette++;
     if (darkMode) {
-        rules[0].format.setForeground(QColor(143,157,106));
-        commentFormat.setForeground(QColor(90,90,90));
-        rules[1].format.setForeground(QColor(90,90,90));
-        for (int i=2; i<rules.size()-1; i++) {
-            rules[i].format.setForeground(QColor(218,208,133));
-        }
-        rules[rules.size()-1].format.setForeground(QColor(155,112,63));
+        formats[Tokenizer::String].setForeground(QColor(143,157,106));
+        formats[Tokenizer::Comment].setForeground(QColor(90,90,90));
+        formats[Tokenizer::Keyword].setForeground(QColor(218,208,133));
+        formats[Tokenizer::Function].setForeground(QColor(155,112,63));
     } else {
-        rules[0].format.setForeground(Qt::darkRed);
-        rules[1].format.setForeground(Qt::red);
-        commentFormat.setForeground(Qt::red);
-        for (int i=2; i<rules.size()-1; i++) {
-            rules[i].format.setForeground(Qt::darkGreen);
-        }
-        rules[rules.size()-1].format.setForeground(Qt::blue);
+        formats[Tokenizer::String].setForeground(Qt::darkRed);
+        formats[Tokenizer::Comment].setForeground(Qt::red);
+        formats[Tokenizer::Keyword].setForeground(Qt::darkGreen);
+        formats[Tokenizer::Function].setForeground(Qt::blue);
     }
 }
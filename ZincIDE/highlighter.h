@@ -17,6 +17,8 @@
 #include <QTextCharFormat>
 #include <QTextDocument>
 
+#include "tokenizer.h"
+
 struct Bracket {
     QChar b;
     int pos;
@@ -25,7 +27,31 @@ struct Bracket {
 class BracketData : public QTextBlockUserData
 {
 public:
+    BracketData(const QTextDocument* d) : foldOpen(-1), depthChange(0), dedent(0), depth(-1), doc(d), palette(-1) {}
+    /// Removes the words of the block from the CompletionIndex
+    ~BracketData(void);
     QVector<Bracket> brackets;
+    /// Index of the outermost opening bracket that is not closed on the
+    /// same line (and therefore starts a fold region), or -1
+    int foldOpen;
+    /// Change in nesting depth from the start to the end of the line
+    /// (brackets and if/endif)
+    int depthChange;
+    /// Number of levels the line itself is outdented by, because it starts
+    /// with closing brackets or then/else/elseif/endif
+    int dedent;
+    /// Nesting depth at the start of the line, cached by the IndentEngine
+    /// (-1 if unknown)
+    int depth;
+    /// The words of the line outside of strings and comments, as counted
+    /// in the CompletionIndex for \a doc
+    const QTextDocument* doc;
+    QStringList words;
+    /// The highlighted tokens, so that a new palette can be applied
+    /// without tokenizing the line again
+    QVector<Tokenizer::Token> tokens;
+    /// The palette the formats of the line were last set with
+    int palette;
 };
 
 class Highlighter : public QSyntaxHighlighter
@@ -33,26 +59,42 @@ class Highlighter : public QSyntaxHighlighter
     Q_OBJECT
 
 public:
-    Highlighter(QFont& font, bool darkMode, QTextDocument *parent = 0);
-    void setEditorFont(QFont& font);
+    /// The highlighter of \a doc, which is created (as a child of the
+    /// document) when the first editor shows it and then shared by all editors
+    static Highlighter* forDocument(QTextDocument* doc, bool darkMode);
     void copyHighlightedToClipboard(QTextCursor selectionCursor);
+    /// Switch the colours. Blocks keep their old colours until they are
+    /// highlighted again or refreshFormats is called for them. The colours
+    /// apply to all views of the document, so the IDE switches the theme
+    /// of all windows at once.
     void setDarkMode(bool);
+    bool isDarkMode(void) const { return darkMode; }
+    /// Apply the current colours to \a block if it was highlighted with an
+    /// earlier palette. Editors call this for the blocks they show.
+    void refreshFormats(const QTextBlock& block);
+    /// Release the layouts, formats and block data of all blocks, to save
+    /// memory while no editor shows the document
+    void release(void);
+    /// Highlight the document again if release was called
+    void restore(void);
+    bool isReleased(void) const { return released; }
+    /// The format used for each Tokenizer::TokenClass
+    const QVector<QTextCharFormat>& tokenFormats(void) const { return formats; }
+    /// Only the first this many characters of a block are highlighted
+    static const int longBlockLength = 10000;
+signals:
+    /// Emitted when a block longer than longBlockLength has been highlighted
+    void longBlockHighlighted(void);
 protected:
+    Highlighter(bool darkMode, QTextDocument *parent);
     void highlightBlock(const QString &text);
 
 private:
-    struct Rule
-    {
-        QRegExp pattern;
-        QTextCharFormat format;
-    };
-    QVector<Rule> rules;
-
-    QTextCharFormat quoteFormat;
-    QTextCharFormat commentFormat;
-    QRegExp commentStartExp;
-    QRegExp commentEndExp;
+    QVector<QTextCharFormat> formats;
     bool darkMode;
+    /// Incremented whenever the colours change
+    int palette;
+    bool released;
 
 };
 
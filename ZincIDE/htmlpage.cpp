@@ -1,11 +1,13 @@
 #include "htmlpage.h"
 #include "mainwindow.h"
+#include "solutionstore.h"
+#include "trace.h"
 #include "QDebug"
 #include <QWebFrame>
 
-HTMLPage::HTMLPage(MainWindow* mw, QWidget *parent) :
-    QWebPage(parent), _mw(mw),
-    loadFinished(false)
+HTMLPage::HTMLPage(MainWindow* mw, SolutionStore* store, int vis, QWidget *parent) :
+    QWebPage(parent), _mw(mw), _store(store), _vis(vis), _sent(0), _finished(-1),
+    loadFinished(false), onDemand(false)
 {
     connect(this, SIGNAL(loadFinished(bool)), this, SLOT(pageLoadFinished(bool)));
     connect(mainFrame(), SIGNAL(javaScriptWindowObjectCleared()), this, SLOT(jsCleared()));
@@ -14,7 +16,7 @@ HTMLPage::HTMLPage(MainWindow* mw, QWidget *parent) :
 void
 HTMLPage::javaScriptConsoleMessage(const QString &message, int lineNumber, const QString &sourceID)
 {
-    _mw->addOutput("<div style='color:red;'>JavaScript message: source " +sourceID + ", line no. " + QString().number(lineNumber) + ": " + message + "</div><br>\n");
+    _mw->addMessage("JavaScript message: source " +sourceID + ", line no. " + QString().number(lineNumber) + ": " + message, OutputConsole::Error);
 }
 
 void
@@ -34,35 +36,61 @@ HTMLPage::pageLoadFinished(bool ok)
 {
     if (ok) {
         loadFinished = true;
-        for (int i=0; i<json.size(); i++) {
-            mainFrame()->evaluateJavaScript(json[i]);
-        }
-        json.clear();
+        // Visualisations that define solutionsAvailable fetch solutions on
+        // demand through mznide.getSolution, all others get every solution
+        // pushed through addSolution
+        onDemand = mainFrame()->evaluateJavaScript("typeof solutionsAvailable == 'function'").toBool();
+        solutionsAdded();
+        if (_finished != -1)
+            finish(_finished);
     }
 }
 
 void
-HTMLPage::addSolution(const QString &json0)
+HTMLPage::solutionsAdded(void)
+{
+    TRACE_SPAN("HTMLPage::solutionsAdded");
+    if (!loadFinished || _sent >= _store->size())
+        return;
+    if (onDemand) {
+        _sent = _store->size();
+        mainFrame()->evaluateJavaScript("solutionsAvailable("+QString().number(_sent)+")");
+    } else {
+        for (; _sent < _store->size(); _sent++) {
+            mainFrame()->evaluateJavaScript("addSolution('"+escapeSolution(_store->get(_sent, _vis))+"')");
+        }
+    }
+}
+
+QString
+HTMLPage::escapeSolution(const QString& json)
 {
-    QString j = json0;
+    QString j = json;
     j.replace("'","\\'");
     j.replace("\"","\\\"");
     j.replace("\n"," ");
-    if (loadFinished) {
-        mainFrame()->evaluateJavaScript("addSolution('"+j+"')");
-    } else {
-        json.push_back("addSolution('"+j+"')");
-    }
+    return j;
+}
+
+int
+HTMLPage::nSolutions(void) const
+{
+    return _store->size();
+}
+
+QString
+HTMLPage::getSolution(int n) const
+{
+    return _store->get(n, _vis);
 }
 
 void
 HTMLPage::finish(qint64 runtime)
 {
-    QString jscall = "if (typeof finish == 'function') { finish("+QString().number(runtime)+"); }";
     if (loadFinished) {
-        mainFrame()->evaluateJavaScript(jscall);
+        mainFrame()->evaluateJavaScript("if (typeof finish == 'function') { finish("+QString().number(runtime)+"); }");
     } else {
-        json.push_back(jscall);
+        _finished = runtime;
     }
 }
 
@@ -4,20 +4,32 @@
 #include <QWebPage>
 
 class MainWindow;
+class SolutionStore;
 
 class HTMLPage : public QWebPage
 {
     Q_OBJECT
 protected:
     MainWindow* _mw;
-    QStringList json;
+    SolutionStore* _store;
+    int _vis;
+    int _sent;
+    qint64 _finished;
     bool loadFinished;
+    bool onDemand;
 public:
-    explicit HTMLPage(MainWindow* mw, QWidget *parent = 0);
+    explicit HTMLPage(MainWindow* mw, SolutionStore* store, int vis, QWidget *parent = 0);
     virtual void javaScriptConsoleMessage(const QString &message, int lineNumber, const QString &sourceID);
-    void addSolution(const QString& json);
+    /// Pass solutions that were added to the store to the page
+    void solutionsAdded(void);
     void showSolution(int n);
     void finish(qint64 runtime);
+    /// Number of solutions available through getSolution
+    Q_INVOKABLE int nSolutions(void) const;
+    /// The JSON of solution \a n, read from the solution store
+    Q_INVOKABLE QString getSolution(int n) const;
+    /// The JSON of a solution escaped for a single-quoted JavaScript string
+    static QString escapeSolution(const QString& json);
 public slots:
     void selectSolution(int n);
 
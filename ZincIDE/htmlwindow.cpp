@@ -8,7 +8,7 @@
 #include <QDockWidget>
 #include <QCloseEvent>
 
-HTMLWindow::HTMLWindow(const QVector<VisWindowSpec>& specs, MainWindow* mw, QWidget *parent) :
+HTMLWindow::HTMLWindow(const QVector<VisWindowSpec>& specs, MainWindow* mw, SolutionStore* store, QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::HTMLWindow)
 {
@@ -16,7 +16,7 @@ HTMLWindow::HTMLWindow(const QVector<VisWindowSpec>& specs, MainWindow* mw, QWid
 
     for (int i=0; i<specs.size(); i++) {
         QWebView* wv = new QWebView;
-        HTMLPage* p = new HTMLPage(mw,wv);
+        HTMLPage* p = new HTMLPage(mw,store,i,wv);
         pages.append(p);
         wv->setPage(p);
         loadQueue.append(QPair<QWebView*,QString>(wv,specs[i].url));
@@ -39,9 +39,11 @@ HTMLWindow::~HTMLWindow()
     delete ui;
 }
 
-void HTMLWindow::addSolution(int nVis, const QString &json)
+void HTMLWindow::solutionsAdded(void)
 {
-    pages[nVis]->addSolution(json);
+    for (int i=0; i<pages.size(); i++) {
+        pages[i]->solutionsAdded();
+    }
 }
 
 void HTMLWindow::selectSolution(HTMLPage *source, int n)
@@ -10,6 +10,7 @@ class HTMLWindow;
 }
 
 class MainWindow;
+class SolutionStore;
 
 class VisWindowSpec {
 public:
@@ -25,10 +26,10 @@ class HTMLWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit HTMLWindow(const QVector<VisWindowSpec>& specs, MainWindow* mw, QWidget *parent = 0);
+    explicit HTMLWindow(const QVector<VisWindowSpec>& specs, MainWindow* mw, SolutionStore* store, QWidget *parent = 0);
     ~HTMLWindow();
 
-    void addSolution(int nVis, const QString& json);
+    void solutionsAdded(void);
     void selectSolution(HTMLPage* source, int n);
     void finish(qint64 runtime);
 private:
@@ -0,0 +1,71 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "indentengine.h"
+#include "highlighter.h"
+
+#include <algorithm>
+
+IndentEngine::IndentEngine(QTextDocument* doc, QObject* parent)
+    : QObject(parent), _doc(doc), _valid(0)
+{
+    connect(doc, SIGNAL(contentsChange(int,int,int)), this, SLOT(contentsChange(int,int,int)));
+}
+
+void IndentEngine::contentsChange(int position, int, int)
+{
+    _valid = std::min(_valid, _doc->findBlock(position).blockNumber());
+}
+
+int IndentEngine::depth(const QTextBlock& block)
+{
+    // Find the closest block at or before this one with a valid depth
+    QTextBlock start = block;
+    int depth = 0;
+    while (start.isValid()) {
+        BracketData* bd = static_cast<BracketData*>(start.userData());
+        if (bd && bd->depth != -1 && start.blockNumber() < _valid) {
+            depth = bd->depth;
+            break;
+        }
+        start = start.previous();
+    }
+    if (!start.isValid()) {
+        start = _doc->begin();
+        depth = 0;
+    }
+    // Propagate forward, caching the depth of each block on the way
+    int missing = -1;
+    for (;;) {
+        BracketData* bd = static_cast<BracketData*>(start.userData());
+        if (bd) {
+            bd->depth = depth;
+        } else if (missing == -1) {
+            // Not highlighted yet, so the depths from here on are only estimates
+            missing = start.blockNumber();
+        }
+        if (start==block)
+            break;
+        if (bd)
+            depth = std::max(0, depth+bd->depthChange);
+        start = start.next();
+    }
+    if (missing == -1) {
+        _valid = std::max(_valid, block.blockNumber()+1);
+    } else {
+        _valid = std::min(_valid, missing);
+    }
+    return depth;
+}
+
+int IndentEngine::indentation(const QTextBlock& block)
+{
+    if (block.previous().userState()==1)
+        return -1;
+    BracketData* bd = static_cast<BracketData*>(block.userData());
+    int d = depth(block);
+    if (bd)
+        d -= bd->dedent;
+    return std::max(0, d)*indentWidth;
+}
@@ -0,0 +1,38 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INDENTENGINE_H
+#define INDENTENGINE_H
+
+#include <QObject>
+#include <QTextBlock>
+#include <QTextDocument>
+
+/// Computes the indentation of lines from their nesting depth.
+///
+/// The depth at the start of each block is derived from the BracketData
+/// recorded by the Highlighter and cached in it. All cached depths before
+/// a watermark block are known to be valid; an edit moves the watermark
+/// back to the changed block, so only the region between the edit and the
+/// line being indented has to be recomputed.
+class IndentEngine : public QObject
+{
+    Q_OBJECT
+public:
+    IndentEngine(QTextDocument* doc, QObject* parent);
+    /// Nesting depth at the start of \a block
+    int depth(const QTextBlock& block);
+    /// The indentation (in spaces) \a block should have, or -1 if it
+    /// should be left alone (e.g. inside a block comment)
+    int indentation(const QTextBlock& block);
+    /// Number of spaces per level
+    static const int indentWidth = 2;
+private slots:
+    void contentsChange(int position, int removed, int added);
+private:
+    QTextDocument* _doc;
+    int _valid;
+};
+
+#endif // INDENTENGINE_H
@@ -0,0 +1,87 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "librarybrowser.h"
+#include "libraryindex.h"
+
+#include <QFileInfo>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QSplitter>
+#include <QTextBrowser>
+#include <QVBoxLayout>
+
+/// Showing more results than this does not help finding anything
+static const int maxResults = 500;
+
+LibraryBrowser::LibraryBrowser(LibraryIndex* index, QWidget *parent)
+    : QWidget(parent), _index(index)
+{
+    _search = new QLineEdit;
+    _search->setPlaceholderText("Search predicates and functions");
+    _results = new QListWidget;
+    _results->setUniformItemSizes(true);
+    _doc = new QTextBrowser;
+    QSplitter* splitter = new QSplitter(Qt::Vertical);
+    splitter->addWidget(_results);
+    splitter->addWidget(_doc);
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->setContentsMargins(0,0,0,0);
+    layout->addWidget(_search);
+    layout->addWidget(splitter);
+    setLayout(layout);
+
+    connect(_search, SIGNAL(textChanged(QString)), this, SLOT(refresh()));
+    connect(_search, SIGNAL(returnPressed()), this, SLOT(insertCurrent()));
+    connect(_results, SIGNAL(currentItemChanged(QListWidgetItem*,QListWidgetItem*)),
+            this, SLOT(showEntry(QListWidgetItem*)));
+    connect(_results, SIGNAL(itemActivated(QListWidgetItem*)), this, SLOT(insertEntry(QListWidgetItem*)));
+    connect(_index, SIGNAL(updated()), this, SLOT(refresh()));
+    refresh();
+}
+
+void LibraryBrowser::refresh(void)
+{
+    QVector<int> hits = _index->search(_search->text(), maxResults);
+    _results->setUpdatesEnabled(false);
+    _results->clear();
+    for (int i=0; i<hits.size(); i++) {
+        const LibraryIndex::Entry& e = _index->entry(hits[i]);
+        QListWidgetItem* item = new QListWidgetItem(e.name+"  ("+QFileInfo(e.file).fileName()+")");
+        item->setData(Qt::UserRole, hits[i]);
+        item->setToolTip(e.signature);
+        _results->addItem(item);
+    }
+    _results->setUpdatesEnabled(true);
+    if (_results->count() > 0)
+        _results->setCurrentRow(0);
+    else
+        _doc->clear();
+}
+
+void LibraryBrowser::showEntry(QListWidgetItem* item)
+{
+    if (item==NULL) {
+        _doc->clear();
+        return;
+    }
+    const LibraryIndex::Entry& e = _index->entry(item->data(Qt::UserRole).toInt());
+    QString html = "<p><code>"+e.signature.toHtmlEscaped()+"</code></p>";
+    if (!e.doc.isEmpty())
+        html += "<p>"+e.doc.toHtmlEscaped().replace("\n\n", "</p><p>")+"</p>";
+    html += "<p><i>"+QFileInfo(e.file).fileName().toHtmlEscaped()+":"+QString().number(e.line)+"</i></p>";
+    _doc->setHtml(html);
+}
+
+void LibraryBrowser::insertEntry(QListWidgetItem* item)
+{
+    if (item==NULL)
+        return;
+    emit insertRequested(_index->entry(item->data(Qt::UserRole).toInt()).callTemplate());
+}
+
+void LibraryBrowser::insertCurrent(void)
+{
+    insertEntry(_results->currentItem());
+}
@@ -0,0 +1,38 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LIBRARYBROWSER_H
+#define LIBRARYBROWSER_H
+
+#include <QWidget>
+
+class LibraryIndex;
+class QLineEdit;
+class QListWidget;
+class QListWidgetItem;
+class QTextBrowser;
+
+/// Searchable list of the predicates and functions in a LibraryIndex,
+/// showing the documentation of the selected one
+class LibraryBrowser : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LibraryBrowser(LibraryIndex* index, QWidget *parent = 0);
+signals:
+    /// Emitted when the user asks to insert the call \a text into the current editor
+    void insertRequested(const QString& text);
+private slots:
+    void refresh(void);
+    void showEntry(QListWidgetItem* item);
+    void insertEntry(QListWidgetItem* item);
+    void insertCurrent(void);
+private:
+    LibraryIndex* _index;
+    QLineEdit* _search;
+    QListWidget* _results;
+    QTextBrowser* _doc;
+};
+
+#endif // LIBRARYBROWSER_H
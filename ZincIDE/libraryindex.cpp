@@ -0,0 +1,378 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "libraryindex.h"
+#include "solverdialog.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+static const quint32 cacheMagic = 0x4c494458;
+static const quint32 cacheVersion = 1;
+
+namespace {
+    bool isIdentChar(QChar c)
+    {
+        return c.isLetterOrNumber() || c=='_';
+    }
+
+    /// Position after the bracket closing the one at \a i, or -1
+    int matchingParen(const QString& s, int i)
+    {
+        int depth = 0;
+        for (; i < s.size(); i++) {
+            if (s[i]=='(' || s[i]=='[' || s[i]=='{') {
+                depth++;
+            } else if (s[i]==')' || s[i]==']' || s[i]=='}') {
+                if (--depth == 0)
+                    return i+1;
+            }
+        }
+        return -1;
+    }
+
+    /// Strip the comment markers from a block comment
+    QString cleanBlockComment(const QString& c)
+    {
+        QStringList lines = c.mid(2, c.size()-4).split('\n');
+        QStringList result;
+        for (int i=0; i<lines.size(); i++) {
+            QString l = lines[i].trimmed();
+            while (l.startsWith('*'))
+                l.remove(0, 1);
+            l = l.trimmed();
+            if (!l.startsWith('@'))
+                result.append(l);
+        }
+        return result.join("\n").trimmed();
+    }
+
+    bool entryLess(const LibraryIndex::Entry& a, const LibraryIndex::Entry& b)
+    {
+        return a.name.toLower() < b.name.toLower();
+    }
+}
+
+QString LibraryIndex::Entry::callTemplate(void) const
+{
+    int open = signature.indexOf('(');
+    int close = open==-1 ? -1 : matchingParen(signature, open);
+    if (close==-1)
+        return name;
+    // Each parameter is "type: name", where the type may contain brackets
+    // but no single colon at the top level
+    QStringList params;
+    int depth = 0;
+    bool wantName = false;
+    QString param;
+    for (int i=open+1; i<close-1; i++) {
+        QChar c = signature[i];
+        if (c=='(' || c=='[' || c=='{') {
+            depth++;
+        } else if (c==')' || c==']' || c=='}') {
+            depth--;
+        } else if (depth==0 && c==',') {
+            params.append(param);
+            param.clear();
+            wantName = false;
+        } else if (depth==0 && c==':' && !wantName && param.isEmpty() &&
+                   (i+1 >= close-1 || signature[i+1]!=':') && signature[i-1]!=':') {
+            wantName = true;
+        } else if (wantName && isIdentChar(c)) {
+            param += c;
+        } else if (wantName && !param.isEmpty()) {
+            wantName = false;
+        }
+    }
+    if (!param.isEmpty())
+        params.append(param);
+    return name+"("+params.join(", ")+")";
+}
+
+LibraryIndex::LibraryIndex(QObject *parent)
+    : QThread(parent), _cacheLoaded(false)
+{
+    connect(this, SIGNAL(finished()), this, SLOT(publish()));
+}
+
+LibraryIndex::~LibraryIndex(void)
+{
+    wait();
+}
+
+void LibraryIndex::update(const QStringList& dirs)
+{
+    if (isRunning()) {
+        _pendingDirs = dirs;
+        return;
+    }
+    _dirs = dirs;
+    start(QThread::LowPriority);
+}
+
+QStringList LibraryIndex::libraryDirs(const QString& distribPath, const QVector<Solver>& solvers)
+{
+    QDir bin(distribPath);
+    QStringList candidates;
+    candidates << "../share/zinc" << "../share/minizinc" << "share/zinc" << "share/minizinc";
+    QString root;
+    for (int i=0; i<candidates.size(); i++) {
+        QString r = QDir::cleanPath(bin.absoluteFilePath(candidates[i]));
+        if (QFileInfo(r+"/std").isDir()) {
+            root = r;
+            break;
+        }
+    }
+    QStringList dirs;
+    if (!root.isEmpty())
+        dirs << root+"/std";
+    for (int i=0; i<solvers.size(); i++) {
+        QString lib = solvers[i].mznlib;
+        if (lib.startsWith("-G")) {
+            // A library installed next to the standard library
+            if (root.isEmpty())
+                continue;
+            lib = root+"/"+lib.mid(2);
+        }
+        lib = QDir::cleanPath(lib);
+        if (!lib.isEmpty() && QFileInfo(lib).isDir() && !dirs.contains(lib))
+            dirs << lib;
+    }
+    return dirs;
+}
+
+QVector<int> LibraryIndex::search(const QString& text, int max) const
+{
+    QVector<int> result;
+    QString t = text.trimmed().toLower();
+    QStringList::const_iterator it = std::lower_bound(_keys.begin(), _keys.end(), t);
+    for (; it != _keys.end() && result.size() < max && it->startsWith(t); ++it)
+        result.append(it-_keys.begin());
+    if (t.isEmpty())
+        return result;
+    for (int i=0; i<_keys.size() && result.size() < max; i++) {
+        if (!_keys[i].startsWith(t) && _keys[i].contains(t))
+            result.append(i);
+    }
+    return result;
+}
+
+void LibraryIndex::run()
+{
+    if (!_cacheLoaded) {
+        loadCache();
+        _cacheLoaded = true;
+    }
+    bool changed = false;
+    _result.clear();
+    for (int i=0; i<_dirs.size(); i++) {
+        QFileInfoList files = QDir(_dirs[i]).entryInfoList(QStringList("*.mzn"), QDir::Files, QDir::Name);
+        for (int j=0; j<files.size(); j++) {
+            QString path = files[j].absoluteFilePath();
+            qint64 mtime = files[j].lastModified().toMSecsSinceEpoch();
+            QHash<QString,FileIndex>::iterator f = _files.find(path);
+            if (f==_files.end() || f.value().mtime != mtime) {
+                FileIndex fi;
+                fi.mtime = mtime;
+                fi.entries = parse(path);
+                f = _files.insert(path, fi);
+                changed = true;
+            }
+            _result += f.value().entries;
+        }
+    }
+    QHash<QString,FileIndex>::iterator f = _files.begin();
+    while (f != _files.end()) {
+        if (QFileInfo(f.key()).exists()) {
+            ++f;
+        } else {
+            f = _files.erase(f);
+            changed = true;
+        }
+    }
+    if (changed)
+        saveCache();
+    std::stable_sort(_result.begin(), _result.end(), entryLess);
+}
+
+void LibraryIndex::publish(void)
+{
+    _entries = _result;
+    _result.clear();
+    _keys.clear();
+    for (int i=0; i<_entries.size(); i++)
+        _keys.append(_entries[i].name.toLower());
+    emit updated();
+    if (!_pendingDirs.isEmpty()) {
+        QStringList dirs = _pendingDirs;
+        _pendingDirs.clear();
+        update(dirs);
+    }
+}
+
+QString LibraryIndex::cacheFile(void)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)+"/library-index";
+}
+
+void LibraryIndex::loadCache(void)
+{
+    QFile f(cacheFile());
+    if (!f.open(QFile::ReadOnly))
+        return;
+    QDataStream in(&f);
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion)
+        return;
+    qint32 nFiles;
+    in >> nFiles;
+    for (int i=0; i<nFiles && in.status()==QDataStream::Ok; i++) {
+        QString path;
+        FileIndex fi;
+        qint32 nEntries;
+        in >> path >> fi.mtime >> nEntries;
+        for (int j=0; j<nEntries && in.status()==QDataStream::Ok; j++) {
+            Entry e;
+            qint32 line;
+            in >> e.name >> e.signature >> e.doc >> line;
+            e.file = path;
+            e.line = line;
+            fi.entries.append(e);
+        }
+        _files.insert(path, fi);
+    }
+    if (in.status() != QDataStream::Ok)
+        _files.clear();
+}
+
+void LibraryIndex::saveCache(void)
+{
+    QDir().mkpath(QFileInfo(cacheFile()).absolutePath());
+    QSaveFile f(cacheFile());
+    if (!f.open(QFile::WriteOnly))
+        return;
+    QDataStream out(&f);
+    out << cacheMagic << cacheVersion << qint32(_files.size());
+    for (QHash<QString,FileIndex>::const_iterator it = _files.begin(); it != _files.end(); ++it) {
+        const QVector<Entry>& entries = it.value().entries;
+        out << it.key() << it.value().mtime << qint32(entries.size());
+        for (int j=0; j<entries.size(); j++)
+            out << entries[j].name << entries[j].signature << entries[j].doc << qint32(entries[j].line);
+    }
+    f.commit();
+}
+
+QVector<LibraryIndex::Entry> LibraryIndex::parse(const QString& fileName)
+{
+    QVector<Entry> result;
+    QFile f(fileName);
+    if (!f.open(QFile::ReadOnly))
+        return result;
+    QString text = QString::fromUtf8(f.readAll());
+    int n = text.size();
+    int line = 1;
+    // The comment directly preceding the current position, if any
+    QString doc;
+    bool haveDoc = false;
+    bool lastWasLineComment = false;
+    int i = 0;
+    while (i < n) {
+        QChar c = text[i];
+        if (c=='\n') {
+            line++;
+            i++;
+        } else if (c.isSpace()) {
+            i++;
+        } else if (c=='%') {
+            int end = text.indexOf('\n', i);
+            if (end==-1)
+                end = n;
+            QString l = text.mid(i+1, end-i-1).trimmed();
+            if (lastWasLineComment && haveDoc)
+                doc += "\n"+l;
+            else
+                doc = l;
+            haveDoc = true;
+            lastWasLineComment = true;
+            i = end;
+        } else if (c=='/' && i+1 < n && text[i+1]=='*') {
+            int end = text.indexOf("*/", i+2);
+            end = end==-1 ? n : end+2;
+            QString comment = text.mid(i, end-i);
+            line += comment.count('\n');
+            doc = cleanBlockComment(comment);
+            haveDoc = true;
+            lastWasLineComment = false;
+            i = end;
+        } else if (c=='"') {
+            for (i++; i < n && text[i]!='"' && text[i]!='\n'; i++) {
+                if (text[i]=='\\')
+                    i++;
+            }
+            i++;
+            haveDoc = false;
+            lastWasLineComment = false;
+        } else if (isIdentChar(c)) {
+            int start = i;
+            while (i < n && isIdentChar(text[i]))
+                i++;
+            QString word = text.mid(start, i-start);
+            if (word=="predicate" || word=="function" || word=="test") {
+                // The declaration ends at its body or at the semicolon
+                int depth = 0;
+                int end = i;
+                for (; end < n; end++) {
+                    QChar d = text[end];
+                    if (d=='(' || d=='[' || d=='{') {
+                        depth++;
+                    } else if (d==')' || d==']' || d=='}') {
+                        depth--;
+                    } else if (depth==0 && (d==';' || d=='=')) {
+                        break;
+                    } else if (d=='"') {
+                        end = text.indexOf('"', end+1);
+                        if (end==-1)
+                            end = n-1;
+                    }
+                }
+                QString decl = text.mid(start, end-start);
+                QString signature = decl.simplified();
+                int open = signature.indexOf('(');
+                int nameEnd = open;
+                while (nameEnd > 0 && signature[nameEnd-1]==' ')
+                    nameEnd--;
+                int nameStart = nameEnd;
+                while (nameStart > 0 && isIdentChar(signature[nameStart-1]))
+                    nameStart--;
+                if (open > 0 && nameStart < nameEnd) {
+                    Entry e;
+                    e.name = signature.mid(nameStart, nameEnd-nameStart);
+                    e.signature = signature;
+                    e.doc = haveDoc ? doc : QString();
+                    e.file = fileName;
+                    e.line = line;
+                    if (e.name != word)
+                        result.append(e);
+                }
+                line += decl.count('\n');
+                i = end;
+            }
+            haveDoc = false;
+            lastWasLineComment = false;
+        } else {
+            haveDoc = false;
+            lastWasLineComment = false;
+            i++;
+        }
+    }
+    return result;
+}
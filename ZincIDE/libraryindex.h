@@ -0,0 +1,81 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LIBRARYINDEX_H
+#define LIBRARYINDEX_H
+
+#include <QThread>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+struct Solver;
+
+/// Index of the predicates and functions declared in the standard library
+/// and the solver-specific (mznlib) libraries.
+///
+/// Library files are parsed in a background thread. The result is kept in
+/// a cache file together with the modification time of each library file,
+/// so only files that have changed since the last run are parsed again.
+/// Searching uses a list of entries sorted by name, so prefix matches are
+/// found by binary search.
+class LibraryIndex : public QThread
+{
+    Q_OBJECT
+public:
+    struct Entry {
+        QString name;
+        /// The declaration up to its body, e.g. "predicate alldifferent(array[int] of var int: x)"
+        QString signature;
+        /// The documentation comment preceding the declaration
+        QString doc;
+        QString file;
+        int line;
+        Entry(void) : line(0) {}
+        /// A call with the parameter names as placeholders, e.g. "alldifferent(x)"
+        QString callTemplate(void) const;
+    };
+
+    explicit LibraryIndex(QObject *parent = 0);
+    ~LibraryIndex(void);
+
+    /// Index the library files in \a dirs in the background
+    void update(const QStringList& dirs);
+    /// The library directories for the installation in \a distribPath and \a solvers
+    static QStringList libraryDirs(const QString& distribPath, const QVector<Solver>& solvers);
+
+    int size(void) const { return _entries.size(); }
+    const Entry& entry(int i) const { return _entries[i]; }
+    /// Indices of at most \a max entries matching \a text: names starting
+    /// with it first, then names containing it (all entries if \a text is empty)
+    QVector<int> search(const QString& text, int max) const;
+signals:
+    /// Emitted when a new index is available
+    void updated(void);
+protected:
+    void run();
+private slots:
+    void publish(void);
+private:
+    struct FileIndex {
+        qint64 mtime;
+        QVector<Entry> entries;
+    };
+    /// Used by the indexing thread only while it is running
+    QHash<QString,FileIndex> _files;
+    bool _cacheLoaded;
+    QStringList _dirs;
+    QStringList _pendingDirs;
+    QVector<Entry> _result;
+    /// Published entries, sorted by lower case name
+    QVector<Entry> _entries;
+    QStringList _keys;
+
+    static QString cacheFile(void);
+    void loadCache(void);
+    void saveCache(void);
+    static QVector<Entry> parse(const QString& fileName);
+};
+
+#endif // LIBRARYINDEX_H
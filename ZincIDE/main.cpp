@@ -12,9 +12,22 @@
 
 #include "mainwindow.h"
 
+#include <QFileInfo>
+#include <QMessageBox>
+
 int main(int argc, char *argv[])
 {
     IDE a(argc, argv);
+    QMap<QString,QString> recovered = EditJournal::recover();
+    if (!recovered.isEmpty()) {
+        int ret = QMessageBox::question(NULL, "MiniZinc IDE",
+                                        "MiniZinc IDE did not shut down properly.\n"
+                                        "Do you want to restore the unsaved changes to "+
+                                        QString().number(recovered.size())+" file(s)?",
+                                        QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        if (ret != QMessageBox::Yes)
+            recovered.clear();
+    }
     QStringList args = QApplication::arguments();
     QStringList files;
     bool hadProject = false;
@@ -27,10 +40,20 @@ int main(int argc, char *argv[])
             files << args[i];
         }
     }
+    QStringList restore;
+    for (QMap<QString,QString>::const_iterator it = recovered.begin(); it != recovered.end(); ++it) {
+        if (!files.contains(it.key()) && QFileInfo(it.key()).exists())
+            restore << it.key();
+    }
     if (!hadProject) {
-        MainWindow* w = new MainWindow(files);
+        MainWindow* w = new MainWindow(files+restore);
+        w->show();
+    } else if (!restore.isEmpty()) {
+        MainWindow* w = new MainWindow(restore);
         w->show();
     }
+    a.restoreDocuments(recovered);
+    EditJournal::removeJournals();
 #ifdef Q_OS_MAC
     a.setQuitOnLastWindowClosed(false);
 #endif
@@ -16,6 +16,7 @@
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <csignal>
+#include <algorithm>
 #include <QtDebug>
 
 #include "mainwindow.h"
@@ -29,6 +30,10 @@
 #include "paramdialog.h"
 #include "checkupdatedialog.h"
 #include "courserasubmission.h"
+#include "documentexporter.h"
+#include "tokenizer.h"
+#include "completionindex.h"
+#include "trace.h"
 
 #include <QtGlobal>
 #ifdef Q_OS_WIN
@@ -139,18 +144,16 @@ bool IDE::event(QEvent *e)
 }
 
 void IDE::checkUpdate(void) {
-    QSettings settings;
-    settings.sync();
+    Settings* settings = Settings::instance();
 
-    settings.beginGroup("ide");
-    if (settings.value("checkforupdates",false).toBool()) {
-        if (settings.value("lastCheck",QDate::currentDate().addDays(-2)).toDate() < QDate::currentDate()) {
+    if (settings->value("ide/checkforupdates",false).toBool()) {
+        if (settings->value("ide/lastCheck",QDate::currentDate().addDays(-2)).toDate() < QDate::currentDate()) {
             QString url_s = "http://www.minizinc.org/ide/version-info.php";
-            if (settings.value("sendstats",false).toBool()) {
+            if (settings->value("ide/sendstats",false).toBool()) {
                 url_s += "?version="+applicationVersion();
                 url_s += "&os=";
                 url_s += MZNOS;
-                url_s += "&uid="+settings.value("uuid","unknown").toString();
+                url_s += "&uid="+settings->value("ide/uuid","unknown").toString();
                 url_s += "&stats="+stats.toJson();
             }
             QUrl url(url_s);
@@ -162,7 +165,6 @@ void IDE::checkUpdate(void) {
         }
         QTimer::singleShot(24*60*60*1000, this, SLOT(checkUpdate()));
     }
-    settings.endGroup();
 }
 
 
@@ -178,27 +180,22 @@ IDE::IDE(int& argc, char* argv[]) : QApplication(argc,argv) {
 
     networkManager = new QNetworkAccessManager(this);
 
-    QSettings settings;
-    settings.sync();
+    Settings* settings = Settings::instance();
 
-    settings.beginGroup("ide");
-    if (settings.value("lastCheck",QDate()).toDate().isNull()) {
-        settings.setValue("uuid", QUuid::createUuid().toString());
+    if (settings->value("ide/lastCheck",QDate()).toDate().isNull()) {
+        settings->setValue("ide/uuid", QUuid::createUuid().toString());
 
         CheckUpdateDialog cud;
         int result = cud.exec();
 
-        settings.setValue("lastCheck",QDate::currentDate().addDays(-2));
-        settings.setValue("checkforupdates",result==QDialog::Accepted);
-        settings.setValue("sendstats",cud.sendStats());
+        settings->setValue("ide/lastCheck",QDate::currentDate().addDays(-2));
+        settings->setValue("ide/checkforupdates",result==QDialog::Accepted);
+        settings->setValue("ide/sendstats",cud.sendStats());
     }
-    settings.endGroup();
-    settings.beginGroup("Recent");
-    recentFiles = settings.value("files",QStringList()).toStringList();
-    recentProjects = settings.value("projects",QStringList()).toStringList();
-    settings.endGroup();
+    recentFiles = settings->value("Recent/files",QStringList()).toStringList();
+    recentProjects = settings->value("Recent/projects",QStringList()).toStringList();
 
-    stats.init(settings.value("statistics"));
+    stats.init(settings->value("statistics"));
 
     lastDefaultProject = NULL;
     helpWindow = new Help();
@@ -212,15 +209,11 @@ IDE::IDE(int& argc, char* argv[]) : QApplication(argc,argv) {
             qDebug() << "internal error: cannot open cheat sheet.";
         }
 
-        QSettings settings;
-        settings.beginGroup("MainWindow");
-
         QFont defaultFont("Courier New");
         defaultFont.setStyleHint(QFont::Monospace);
         defaultFont.setPointSize(13);
-        QFont editorFont = settings.value("editorFont", defaultFont).value<QFont>();
-        bool darkMode = settings.value("darkMode", false).value<bool>();
-        settings.endGroup();
+        QFont editorFont = settings->value("MainWindow/editorFont", defaultFont).value<QFont>();
+        bool darkMode = settings->value("MainWindow/darkMode", false).value<bool>();
 
         cheatSheet = new QMainWindow;
         cheatSheet->setWindowTitle("MiniZinc Cheat Sheet");
@@ -237,6 +230,11 @@ IDE::IDE(int& argc, char* argv[]) : QApplication(argc,argv) {
 
 
     connect(&fsWatch, SIGNAL(fileChanged(QString)), this, SLOT(fileModified(QString)));
+    journal = new EditJournal(this);
+
+    hibernationTimer.setInterval(60000);
+    connect(&hibernationTimer, SIGNAL(timeout()), this, SLOT(hibernateTabs()));
+    hibernationTimer.start();
 
 #ifdef Q_OS_MAC
     MainWindow* mw = new MainWindow(QString());
@@ -299,16 +297,21 @@ void IDE::fileModified(const QString &f)
             msg.exec();
             if (msg.clickedButton()==cancelButton) {
                 it.value()->td.setModified(true);
+                // The journal can no longer start from the file
+                journal->snapshot(&it.value()->td);
             } else {
                 QFile file(f);
                 if (file.open(QFile::ReadOnly | QFile::Text)) {
+                    journal->unwatch(&it.value()->td);
                     it.value()->td.setPlainText(file.readAll());
                     it.value()->td.setModified(false);
+                    journal->watch(&it.value()->td, f);
                 } else {
                     QMessageBox::warning(NULL, "MiniZinc IDE",
                                          "Could not reload file "+f,
                                          QMessageBox::Ok);
                     it.value()->td.setModified(true);
+                    journal->snapshot(&it.value()->td);
                 }
             }
         }
@@ -322,16 +325,11 @@ void IDE::newProject()
 }
 
 QString IDE::getLastPath(void) {
-    QSettings settings;
-    settings.beginGroup("Path");
-    return settings.value("lastPath","").toString();
+    return Settings::instance()->value("Path/lastPath","").toString();
 }
 
 void IDE::setLastPath(const QString& path) {
-    QSettings settings;
-    settings.beginGroup("Path");
-    settings.setValue("lastPath", path);
-    settings.endGroup();
+    Settings::instance()->setValue("Path/lastPath", path);
 }
 
 void IDE::openFile()
@@ -360,12 +358,101 @@ void IDE::help()
 }
 
 IDE::~IDE(void) {
-    QSettings settings;
-    settings.setValue("statistics",stats.toVariantMap());
-    settings.beginGroup("Recent");
-    settings.setValue("files",recentFiles);
-    settings.setValue("projects",recentProjects);
-    settings.endGroup();
+    Settings* settings = Settings::instance();
+    settings->setValue("statistics",stats.toVariantMap());
+    settings->setValue("Recent/files",recentFiles);
+    settings->setValue("Recent/projects",recentProjects);
+    settings->flush();
+    delete journal;
+}
+
+namespace {
+    struct HibernationCandidate {
+        qint64 lastViewed;
+        MainWindow* mw;
+        CodeEditor* ce;
+        bool operator <(const HibernationCandidate& c) const { return lastViewed < c.lastViewed; }
+    };
+
+    /// Rough size of the text of \a doc
+    qint64 textMemory(QTextDocument* doc)
+    {
+        return qint64(doc->characterCount())*8;
+    }
+
+    /// Rough size of the layouts, formats and block data of \a doc
+    qint64 formattingMemory(QTextDocument* doc)
+    {
+        return qint64(doc->blockCount())*512;
+    }
+}
+
+void IDE::hibernateTabs(void)
+{
+    Settings* settings = Settings::instance();
+    qint64 idleLimit = settings->value("MainWindow/hibernateAfterMinutes", 60).toLongLong()*60000;
+    qint64 budget = settings->value("MainWindow/documentMemoryMB", 0).toLongLong()*1024*1024;
+    if (idleLimit <= 0 && budget <= 0)
+        return;
+
+    // All tabs that are not currently shown are candidates. Unmodified tabs
+    // that are backed by a file release their document, because it can be
+    // reloaded. The others keep their text but release its layouts,
+    // formats and block data, unless another window shows the document.
+    qint64 used = 0;
+    QSet<QTextDocument*> counted;
+    QSet<QTextDocument*> shown;
+    QVector<HibernationCandidate> candidates;
+    for (QSet<MainWindow*>::iterator mw = mainWindows.begin(); mw != mainWindows.end(); ++mw) {
+        if ((*mw)->curEditor)
+            shown.insert((*mw)->curEditor->document());
+        QTabWidget* tabs = (*mw)->ui->tabWidget;
+        for (int i=0; i<tabs->count(); i++) {
+            if (tabs->widget(i) == (*mw)->ui->configuration)
+                continue;
+            CodeEditor* ce = static_cast<CodeEditor*>(tabs->widget(i));
+            if (ce->hibernated)
+                continue;
+            QTextDocument* doc = ce->document();
+            if (!counted.contains(doc)) {
+                counted.insert(doc);
+                used += textMemory(doc);
+                if (!ce->formattingReleased())
+                    used += formattingMemory(doc);
+            }
+            if (ce != (*mw)->curEditor) {
+                HibernationCandidate c;
+                c.lastViewed = ce->lastViewed;
+                c.mw = *mw;
+                c.ce = ce;
+                candidates.append(c);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i=0; i<candidates.size(); i++) {
+        bool idle = idleLimit > 0 && now-candidates[i].lastViewed > idleLimit;
+        bool overBudget = budget > 0 && used > budget;
+        // The candidates are sorted by age, so none of the rest is idle either
+        if (!idle && !overBudget)
+            break;
+        CodeEditor* ce = candidates[i].ce;
+        QTextDocument* doc = ce->document();
+        if (!doc->isModified() && !ce->filepath.isEmpty() && !ce->isReadOnly()) {
+            // The document is only freed with the last editor showing it
+            DMap::iterator it = documents.find(ce->filepath);
+            if (it != documents.end() && it.value()->editors.size()==1) {
+                used -= textMemory(doc);
+                if (!ce->formattingReleased())
+                    used -= formattingMemory(doc);
+            }
+            candidates[i].mw->hibernateEditor(ce);
+        } else if (!ce->formattingReleased() && !shown.contains(doc)) {
+            used -= formattingMemory(doc);
+            ce->releaseFormatting();
+        }
+    }
 }
 
 bool IDE::hasFile(const QString& path)
@@ -382,11 +469,13 @@ QTextDocument* IDE::addDocument(const QString& path, QTextDocument *doc, CodeEdi
     d->large = false;
     documents.insert(path,d);
     fsWatch.addPath(path);
+    journal->watch(&d->td, path);
     return &d->td;
 }
 
 QPair<QTextDocument*,bool> IDE::loadFile(const QString& path, QWidget* parent)
 {
+    TRACE_SPAN("IDE::loadFile");
     DMap::iterator it = documents.find(path);
     if (it==documents.end()) {
         QFile file(path);
@@ -400,8 +489,10 @@ QPair<QTextDocument*,bool> IDE::loadFile(const QString& path, QWidget* parent)
             }
             d->td.setModified(false);
             documents.insert(path,d);
-            if (!d->large)
+            if (!d->large) {
                 fsWatch.addPath(path);
+                journal->watch(&d->td, path);
+            }
             return qMakePair(&d->td,d->large);
         } else {
             QMessageBox::warning(parent, "MiniZinc IDE",
@@ -432,6 +523,7 @@ void IDE::loadLargeFile(const QString &path, QWidget* parent)
                 (*ed)->loadedLargeFile();
             }
             fsWatch.addPath(path);
+            journal->watch(&it.value()->td, path);
         } else {
             QMessageBox::warning(parent, "MiniZinc IDE",
                                  "Could not open file "+path,
@@ -456,6 +548,7 @@ void IDE::removeEditor(const QString& path, CodeEditor* ce)
         QSet<CodeEditor*>& editors = it.value()->editors;
         editors.remove(ce);
         if (editors.empty()) {
+            journal->unwatch(&it.value()->td);
             delete it.value();
             documents.remove(path);
             fsWatch.removePath(path);
@@ -474,6 +567,20 @@ void IDE::renameFile(const QString& oldPath, const QString& newPath)
         fsWatch.removePath(oldPath);
         documents.insert(newPath, doc);
         fsWatch.addPath(newPath);
+        journal->rename(&doc->td, newPath);
+    }
+}
+
+void IDE::restoreDocuments(const QMap<QString,QString>& texts)
+{
+    for (QMap<QString,QString>::const_iterator it = texts.begin(); it != texts.end(); ++it) {
+        DMap::iterator d = documents.find(it.key());
+        if (d == documents.end() || d.value()->large || d.value()->td.toPlainText()==it.value())
+            continue;
+        // A single edit, so the restored changes can be undone
+        QTextCursor cursor(&d.value()->td);
+        cursor.select(QTextCursor::Document);
+        cursor.insertText(it.value());
     }
 }
 
@@ -491,10 +598,7 @@ IDE::versionCheckFinished(void) {
                 QDesktopServices::openUrl(QUrl("http://www.minizinc.org/ide/"));
             }
         }
-        QSettings settings;
-        settings.beginGroup("ide");
-        settings.setValue("lastCheck",QDate::currentDate());
-        settings.endGroup();
+        Settings::instance()->setValue("ide/lastCheck",QDate::currentDate());
         stats.resetCounts();
     }
 }
@@ -515,6 +619,7 @@ MainWindow::MainWindow(const QString& project) :
     ui(new Ui::MainWindow),
     curEditor(NULL),
     curHtmlWindow(NULL),
+    solutionStore(NULL),
     process(NULL),
     outputProcess(NULL),
     tmpDir(NULL),
@@ -529,6 +634,7 @@ MainWindow::MainWindow(const QStringList& files) :
     ui(new Ui::MainWindow),
     curEditor(NULL),
     curHtmlWindow(NULL),
+    solutionStore(NULL),
     process(NULL),
     outputProcess(NULL),
     tmpDir(NULL),
@@ -626,10 +732,52 @@ void MainWindow::init(const QString& projectFile)
     connect(timer, SIGNAL(timeout()), this, SLOT(statusTimerEvent()));
     solverTimeout = new QTimer(this);
     solverTimeout->setSingleShot(true);
-    connect(solverTimeout, SIGNAL(timeout()), this, SLOT(on_actionStop_triggered()));
+    connect(solverTimeout, SIGNAL(timeout()), this, SLOT(solverTimeLimitExceeded()));
+    solverKillTimer = new QTimer(this);
+    solverKillTimer->setSingleShot(true);
+    connect(solverKillTimer, SIGNAL(timeout()), this, SLOT(solverGracePeriodExpired()));
+    solverTimedOut = false;
     statusLabel = new QLabel("");
+    processMonitor = new ProcessMonitor;
+    ui->statusbar->addPermanentWidget(processMonitor);
     ui->statusbar->addPermanentWidget(statusLabel);
     ui->statusbar->showMessage("Ready.");
+
+    convergenceChart = new ConvergenceChart;
+    QAction* clearRuns = new QAction("Clear previous runs", convergenceChart);
+    connect(clearRuns, SIGNAL(triggered()), convergenceChart, SLOT(clearHistory()));
+    convergenceChart->addAction(clearRuns);
+    convergenceChart->setContextMenuPolicy(Qt::ActionsContextMenu);
+    convergenceDock = new QDockWidget("Objective", this);
+    convergenceDock->setObjectName("convergenceDock");
+    convergenceDock->setWidget(convergenceChart);
+    addDockWidget(Qt::RightDockWidgetArea, convergenceDock);
+    convergenceDock->hide();
+    ui->menuView->addAction(convergenceDock->toggleViewAction());
+    haveObjective = false;
+    solutionTime = -1;
+    problemsPanel = new ProblemsPanel;
+    connect(problemsPanel, SIGNAL(problemActivated(QString,int,int)), this, SLOT(problemActivated(QString,int,int)));
+    connect(problemsPanel, SIGNAL(changed(QStringList)), this, SLOT(updateProblemMarkers(QStringList)));
+    problemsDock = new QDockWidget("Problems", this);
+    problemsDock->setObjectName("problemsDock");
+    problemsDock->setWidget(problemsPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, problemsDock);
+    problemsDock->hide();
+    ui->menuView->addAction(problemsDock->toggleViewAction());
+    problemContinuation = 0;
+    libraryIndex = new LibraryIndex(this);
+    connect(libraryIndex, SIGNAL(updated()), this, SLOT(libraryIndexUpdated()));
+    LibraryBrowser* libraryBrowser = new LibraryBrowser(libraryIndex);
+    connect(libraryBrowser, SIGNAL(insertRequested(QString)), this, SLOT(insertLibraryCall(QString)));
+    libraryDock = new QDockWidget("Library", this);
+    libraryDock->setObjectName("libraryDock");
+    libraryDock->setWidget(libraryBrowser);
+    addDockWidget(Qt::RightDockWidgetArea, libraryDock);
+    libraryDock->hide();
+    connect(libraryDock, SIGNAL(visibilityChanged(bool)), this, SLOT(libraryDockVisibilityChanged(bool)));
+    ui->menuView->addAction(libraryDock->toggleViewAction());
+    checker = new BackgroundChecker(this);
     ui->actionStop->setEnabled(false);
     QTabBar* tb = ui->tabWidget->findChild<QTabBar*>();
     tb->setTabButton(0, QTabBar::RightSide, 0);
@@ -637,114 +785,42 @@ void MainWindow::init(const QString& projectFile)
     tb->setTabButton(0, QTabBar::LeftSide, 0);
 
     ui->actionSubmit_to_Coursera->setVisible(false);
+    ui->actionExport_solutions->setEnabled(false);
 
     connect(ui->outputConsole, SIGNAL(anchorClicked(QUrl)), this, SLOT(errorClicked(QUrl)));
 
-    QSettings settings;
-    settings.beginGroup("MainWindow");
+    Settings* settings = Settings::instance();
 
     QFont defaultFont("Courier New");
     defaultFont.setStyleHint(QFont::Monospace);
     defaultFont.setPointSize(13);
-    editorFont = settings.value("editorFont", defaultFont).value<QFont>();
-    darkMode = settings.value("darkMode", false).value<bool>();
+    editorFont = settings->value("MainWindow/editorFont", defaultFont).value<QFont>();
+    darkMode = settings->value("MainWindow/darkMode", false).value<bool>();
     ui->actionDark_mode->setChecked(darkMode);
+    ui->actionRecord_performance_trace->setChecked(Trace::isEnabled());
+    ui->actionCheck_in_background->setChecked(settings->value("MainWindow/backgroundCheck", true).toBool());
+    checker->setEnabled(ui->actionCheck_in_background->isChecked());
     ui->outputConsole->setFont(editorFont);
-    resize(settings.value("size", QSize(800, 600)).toSize());
-    move(settings.value("pos", QPoint(100, 100)).toPoint());
-    if (settings.value("toolbarHidden", false).toBool()) {
+    resize(settings->value("MainWindow/size", QSize(800, 600)).toSize());
+    move(settings->value("MainWindow/pos", QPoint(100, 100)).toPoint());
+    if (settings->value("MainWindow/toolbarHidden", false).toBool()) {
         on_actionHide_tool_bar_triggered();
     }
-    if (settings.value("outputWindowHidden", true).toBool()) {
+    if (settings->value("MainWindow/outputWindowHidden", true).toBool()) {
         on_actionOnly_editor_triggered();
     }
-    settings.endGroup();
 
     setEditorFont(editorFont);
 
-    Solver g12fd("G12 fd","flatzinc","-Gg12_fd","",true,false);
-    bool hadg12fd = false;
-    Solver g12lazyfd("G12 lazyfd","flatzinc","-Gg12_lazyfd","-b lazy",true,false);
-    bool hadg12lazyfd = false;
-    Solver g12mip("G12 MIP","flatzinc","-Glinear","-b mip",true,false);
-    bool hadg12mip = false;
-
 #ifdef Q_OS_WIN
     zinc_executable = "zinc.bat";
 #else
     zinc_executable = "zinc";
 #endif
-#ifdef MINIZINC_IDE_BUNDLED
-    Solver gecode("Gecode (bundled)","fzn-gecode","-Ggecode","",true,false);
-    bool hadgecode = false;
-    Solver gecodeGist("Gecode (Gist, bundled)","fzn-gecode-gist","-Ggecode","",true,true);
-    bool hadgecodegist = false;
-#endif
-
-    int nsolvers = settings.beginReadArray("solvers");
-    if (nsolvers==0) {
-#ifdef MINIZINC_IDE_BUNDLED
-        solvers.append(gecode);
-        solvers.append(gecodeGist);
-#endif
-        solvers.append(g12fd);
-        solvers.append(g12lazyfd);
-        solvers.append(g12mip);
-    } else {
-        IDE::instance()->stats.solvers.clear();
-        for (int i=0; i<nsolvers; i++) {
-            settings.setArrayIndex(i);
-            Solver solver;
-            solver.name = settings.value("name").toString();
-            solver.executable = settings.value("executable").toString();
-            solver.mznlib = settings.value("mznlib").toString();
-            solver.backend = settings.value("backend").toString();
-            solver.builtin = settings.value("builtin").toBool();
-            solver.detach = settings.value("detach",false).toBool();
-            if (solver.builtin) {
-                if (solver.name=="G12 fd") {
-                    solver = g12fd;
-                    hadg12fd = true;
-                } else if (solver.name=="G12 lazyfd") {
-                    solver = g12lazyfd;
-                    hadg12lazyfd = true;
-                } else if (solver.name=="G12 MIP") {
-                    solver = g12mip;
-                    hadg12mip = true;
-                }
-#ifdef MINIZINC_IDE_BUNDLED
-                else if (solver.name=="Gecode (bundled)") {
-                    solver = gecode;
-                    hadgecode = true;
-                }
-                else if (solver.name=="Gecode (Gist, bundled)") {
-                    solver = gecodeGist;
-                    hadgecodegist = true;
-                }
-#endif
-            } else {
-                IDE::instance()->stats.solvers.append(solver.name);
-            }
-            solvers.append(solver);
-        }
-        if (!hadg12fd)
-            solvers.append(g12fd);
-        if (!hadg12lazyfd)
-            solvers.append(g12lazyfd);
-        if (!hadg12mip)
-            solvers.append(g12mip);
-#ifdef MINIZINC_IDE_BUNDLED
-        if (!hadgecodegist)
-            solvers.push_front(gecodeGist);
-        if (!hadgecode)
-            solvers.push_front(gecode);
-#endif
-    }
-    settings.endArray();
-    settings.beginGroup("minizinc");
-    zincDistribPath = settings.value("zincpath","").toString();
-    settings.endGroup();
+    loadSolvers();
+    zincDistribPath = settings->value("minizinc/zincpath","").toString();
     checkMznPath();
+    updateLibraryIndex();
 
     connect(QApplication::clipboard(), SIGNAL(dataChanged()), this, SLOT(onClipboardChanged()));
 
@@ -780,6 +856,11 @@ void MainWindow::init(const QString& projectFile)
     connect(ui->conf_stats, SIGNAL(toggled(bool)), &project, SLOT(printStats(bool)));
     connect(ui->conf_have_solverFlags, SIGNAL(toggled(bool)), &project, SLOT(haveSolverFlags(bool)));
     connect(ui->conf_solver_verbose, SIGNAL(toggled(bool)), &project, SLOT(solverVerbose(bool)));
+    connect(ui->conf_timeLimit, SIGNAL(valueChanged(int)), &project, SLOT(timeLimit(int)));
+    connect(ui->conf_memLimit, SIGNAL(valueChanged(int)), &project, SLOT(memoryLimit(int)));
+    // textChanged rather than textEdited, so that loading a project also updates the checker
+    connect(ui->conf_have_zinc_params, SIGNAL(toggled(bool)), this, SLOT(updateCheckerConfig()));
+    connect(ui->conf_zinc_params, SIGNAL(textChanged(QString)), this, SLOT(updateCheckerConfig()));
 
     if (!projectFile.isEmpty()) {
         loadProject(projectFile);
@@ -904,15 +985,17 @@ MainWindow::~MainWindow()
         delete cleanupTmpDirs[i];
     }
     for (int i=0; i<cleanupProcesses.size(); i++) {
-        cleanupProcesses[i]->kill();
+        cleanupProcesses[i]->killGroup();
         cleanupProcesses[i]->waitForFinished();
         delete cleanupProcesses[i];
     }
     if (process) {
-        process->kill();
+        process->killGroup();
         process->waitForFinished();
         delete process;
     }
+    delete curHtmlWindow;
+    delete solutionStore;
     delete ui;
     delete paramDialog;
 }
@@ -1047,7 +1130,7 @@ void MainWindow::tabCloseRequest(int tab)
     ce->document()->setModified(false);
     ui->tabWidget->removeTab(tab);
     setupDznMenu();
-    if (!ce->filepath.isEmpty())
+    if (!ce->filepath.isEmpty() && !ce->hibernated)
         IDE::instance()->removeEditor(ce->filepath,ce);
     delete ce;
 }
@@ -1091,7 +1174,7 @@ void MainWindow::closeEvent(QCloseEvent* e) {
     if (process) {
         disconnect(process, SIGNAL(error(QProcess::ProcessError)),
                    this, SLOT(procError(QProcess::ProcessError)));
-        process->kill();
+        process->killGroup();
     }
     for (int i=0; i<ui->tabWidget->count(); i++) {
         if (ui->tabWidget->widget(i) != ui->configuration) {
@@ -1108,15 +1191,13 @@ void MainWindow::closeEvent(QCloseEvent* e) {
 
     IDE::instance()->mainWindows.remove(this);
 
-    QSettings settings;
-    settings.beginGroup("MainWindow");
-    settings.setValue("editorFont", editorFont);
-    settings.setValue("darkMode", darkMode);
-    settings.setValue("size", size());
-    settings.setValue("pos", pos());
-    settings.setValue("toolbarHidden", ui->toolBar->isHidden());
-    settings.setValue("outputWindowHidden", ui->outputDockWidget->isHidden());
-    settings.endGroup();
+    Settings* settings = Settings::instance();
+    settings->setValue("MainWindow/editorFont", editorFont);
+    settings->setValue("MainWindow/darkMode", darkMode);
+    settings->setValue("MainWindow/size", size());
+    settings->setValue("MainWindow/pos", pos());
+    settings->setValue("MainWindow/toolbarHidden", ui->toolBar->isHidden());
+    settings->setValue("MainWindow/outputWindowHidden", ui->outputDockWidget->isHidden());
     e->accept();
 }
 
@@ -1152,6 +1233,8 @@ void MainWindow::tabChange(int tab) {
         disconnect(curEditor->document(), SIGNAL(redoAvailable(bool)),
                    ui->actionRedo, SLOT(setEnabled(bool)));
     }
+    if (curEditor)
+        curEditor->lastViewed = QDateTime::currentMSecsSinceEpoch();
     if (tab==-1) {
         curEditor = NULL;
         ui->actionClose->setEnabled(false);
@@ -1159,6 +1242,10 @@ void MainWindow::tabChange(int tab) {
         if (ui->tabWidget->widget(tab)!=ui->configuration) {
             ui->actionClose->setEnabled(true);
             curEditor = static_cast<CodeEditor*>(ui->tabWidget->widget(tab));
+            if (curEditor->hibernated)
+                wakeEditor(curEditor);
+            curEditor->restoreFormatting();
+            curEditor->lastViewed = QDateTime::currentMSecsSinceEpoch();
             connect(ui->actionCopy, SIGNAL(triggered()), curEditor, SLOT(copy()));
             connect(ui->actionPaste, SIGNAL(triggered()), curEditor, SLOT(paste()));
             connect(ui->actionCut, SIGNAL(triggered()), curEditor, SLOT(cut()));
@@ -1192,6 +1279,7 @@ void MainWindow::tabChange(int tab) {
             }
             ui->actionSave->setEnabled(true);
             ui->actionSave_as->setEnabled(true);
+            ui->actionExport->setEnabled(true);
             ui->actionSelect_All->setEnabled(true);
             ui->actionUndo->setEnabled(curEditor->document()->isUndoAvailable());
             ui->actionRedo->setEnabled(curEditor->document()->isRedoAvailable());
@@ -1208,6 +1296,9 @@ void MainWindow::tabChange(int tab) {
             ui->actionReplace->setEnabled(true);
             ui->actionShift_left->setEnabled(true);
             ui->actionShift_right->setEnabled(true);
+            ui->actionReindent->setEnabled(true);
+            ui->actionFold_arrays->setEnabled(true);
+            ui->actionUnfold_all->setEnabled(true);
             curEditor->setFocus();
         } else {
             curEditor = NULL;
@@ -1217,6 +1308,7 @@ void MainWindow::tabChange(int tab) {
             ui->actionClose->setEnabled(false);
             ui->actionSave->setEnabled(false);
             ui->actionSave_as->setEnabled(false);
+            ui->actionExport->setEnabled(false);
             ui->actionCut->setEnabled(false);
             ui->actionCopy->setEnabled(false);
             ui->actionPaste->setEnabled(false);
@@ -1233,6 +1325,9 @@ void MainWindow::tabChange(int tab) {
             ui->actionReplace->setEnabled(false);
             ui->actionShift_left->setEnabled(false);
             ui->actionShift_right->setEnabled(false);
+            ui->actionReindent->setEnabled(false);
+            ui->actionFold_arrays->setEnabled(false);
+            ui->actionUnfold_all->setEnabled(false);
             findDialog->close();
             setWindowFilePath(projectPath);
             QString p;
@@ -1245,6 +1340,13 @@ void MainWindow::tabChange(int tab) {
             setWindowTitle(p);
         }
     }
+    updateCheckerConfig();
+    checker->setEditor(curEditor);
+}
+
+void MainWindow::updateCheckerConfig(void)
+{
+    checker->setCompiler(zinc_executable, getZincDistribPath(), parseConf(true, true));
 }
 
 void MainWindow::on_actionClose_triggered()
@@ -1347,15 +1449,53 @@ void MainWindow::setupDznMenu()
     ui->conf_data_file2->setCurrentText(curText);
 }
 
-void MainWindow::addOutput(const QString& s, bool html)
+void MainWindow::addOutput(const QString& s)
 {
-    QTextCursor cursor = ui->outputConsole->textCursor();
-    cursor.movePosition(QTextCursor::End);
-    ui->outputConsole->setTextCursor(cursor);
-    if (html)
-        ui->outputConsole->insertHtml(s);
-    else
-        ui->outputConsole->insertPlainText(s);
+    TRACE_SPAN("MainWindow::addOutput");
+    ui->outputConsole->appendText(s);
+}
+
+void MainWindow::addMessage(const QString& s, OutputConsole::Style style)
+{
+    ui->outputConsole->appendMessage(s, style);
+}
+
+void MainWindow::addDiagnosticLine(const QString& line, const QString& dir)
+{
+    // Messages may continue on the lines after the location, up to a blank line
+    static const int maxContinuationLines = 10;
+    DiagnosticParser::Diagnostic d;
+    if (DiagnosticParser::parse(line, d)) {
+        QString location = d.location();
+        d.file = QFileInfo(QDir(dir), d.file).absoluteFilePath();
+        QUrl url = QUrl::fromLocalFile(d.file);
+        url.setQuery("line="+QString().number(d.line));
+        url.setScheme("err");
+        IDE::instance()->stats.errorsShown++;
+        ui->outputConsole->appendLink(location, url, d.message.isEmpty() ? QString() : " "+d.message,
+                                      d.severity==DiagnosticParser::Error ? OutputConsole::Error : OutputConsole::Warning);
+        problemsPanel->add(d);
+        problemContinuation = maxContinuationLines;
+    } else {
+        if (problemContinuation > 0) {
+            QString t = line.trimmed();
+            if (t.isEmpty()) {
+                problemContinuation = 0;
+            } else {
+                problemsPanel->appendToLastMessage(t);
+                problemContinuation--;
+            }
+        }
+        addOutput(line+"\n");
+    }
+}
+
+void MainWindow::clearProblems(void)
+{
+    compileParser.clear();
+    stderrParser.clear();
+    problemContinuation = 0;
+    problemsPanel->clear();
 }
 
 void MainWindow::checkArgsOutput()
@@ -1429,11 +1569,16 @@ void MainWindow::startCompileZinc(QString filepath)
             this, SLOT(procError(QProcess::ProcessError)));
 
     QStringList args = parseCompileConf();
+    compilingTarget = QFileInfo(zincTarget(filepath)).absoluteFilePath();
+    compilingFingerprint = ModelFingerprint::compute(filepath, QStringList(), args);
     args << filepath;
     compileErrors = "";
-    addOutput("<div style='color:blue;'>Compiling "+filepath+"</div><br>");
+    addMessage("Compiling "+filepath);
     elapsedTime.start();
+    processMonitor->reset();
     process->start(zinc_executable,args,getZincDistribPath());
+    time = 0;
+    timer->start(500);
 }
 
 void MainWindow::compileZincOutput()
@@ -1441,23 +1586,24 @@ void MainWindow::compileZincOutput()
     QString l = process->readAll();
     compileErrors += l;
 
-    QRegExp errexp("^(.*zinc):([0-9]+):([0-9]+):(.*)$");
-    if (errexp.indexIn(l) != -1) {
-        QString errFile = errexp.cap(1).trimmed();
-        QUrl url = QUrl::fromLocalFile(errFile);
-        url.setQuery("line="+errexp.cap(2));
-        url.setScheme("err");
-        IDE::instance()->stats.errorsShown++;
-        addOutput("<a style='color:red' href='"+url.toString()+"'>"+errexp.cap(1)+":"+errexp.cap(2)+":</a>"+errexp.cap(4)+"<br>");
-    } else {
-        addOutput(l,false);
-    }
+    QStringList lines = compileParser.lines(l);
+    for (int i=0; i<lines.size(); i++)
+        addDiagnosticLine(lines[i], process->workingDirectory());
 }
 
 void MainWindow::compileZincFinished(int exitcode)
 {
     if (processWasStopped)
         return;
+    QString rest = compileParser.rest();
+    if (!rest.isEmpty())
+        addDiagnosticLine(rest, process->workingDirectory());
+    problemsPanel->flush();
+    if (exitcode == 0) {
+        compiledFingerprints.insert(compilingTarget, compilingFingerprint);
+    } else {
+        compiledFingerprints.remove(compilingTarget);
+    }
     procFinished(exitcode);
     if (exitcode == 0 && !compileOnly) {
         startRunZinc();
@@ -1487,19 +1633,79 @@ void MainWindow::startRunZinc() {
 
     QStringList args = parseRunConf();
     compileErrors = "";
-    addOutput("<div style='color:blue;'>Running "+currentZincTarget+"</div><br>");
+    addMessage("Running "+currentZincTarget);
+    convergenceChart->startRun(currentZincTarget);
+    runOutputLine.clear();
+    haveObjective = false;
+    solutionTime = -1;
+    solverTimedOut = false;
+    process->setMemoryLimit(project.memoryLimit());
     elapsedTime.start();
+    processMonitor->reset();
     process->start(currentZincTarget,args,getZincDistribPath());
+    if (project.timeLimit() > 0) {
+        solverTimeout->start(project.timeLimit()*1000);
+    }
+    time = 0;
+    timer->start(500);
 }
 
 void MainWindow::runZincOutput() {
     QString l = process->readAll();
-    addOutput(l, false);
+    addOutput(l);
+    // Output arrives in arbitrary chunks, scan it line by line
+    runOutputLine += l;
+    int start = 0;
+    int nl;
+    while ((nl = runOutputLine.indexOf('\n', start)) != -1) {
+        trackObjective(runOutputLine.mid(start, nl-start));
+        start = nl+1;
+    }
+    runOutputLine.remove(0, start);
+}
+
+void MainWindow::trackObjective(const QString& line)
+{
+    QString l = line.trimmed();
+    if (l.startsWith("%%%mzn-json-time")) {
+        // The stamp comes with the solution, before the rest of its output
+        solutionTime = elapsedTime.elapsed();
+        return;
+    }
+    if (l == "----------") {
+        if (haveObjective) {
+            if (!convergenceChart->hasPoints())
+                convergenceDock->show();
+            convergenceChart->addPoint(solutionTime >= 0 ? solutionTime : elapsedTime.elapsed(), curObjective);
+            haveObjective = false;
+        }
+        solutionTime = -1;
+        return;
+    }
+    // Matches both "objective = 42" and JSON output like {"objective": 42}
+    static const QRegExp objexp("(?:^|[\\s{,])\"?_?objective\"?\\s*[=:]\\s*(-?[0-9]+(?:\\.[0-9]*)?(?:[eE][-+]?[0-9]+)?)");
+    if (objexp.indexIn(l) != -1) {
+        bool ok;
+        double v = objexp.cap(1).toDouble(&ok);
+        if (ok) {
+            curObjective = v;
+            haveObjective = true;
+        }
+    }
 }
 
 void MainWindow::runZincFinished(int exitcode) {
     if (processWasStopped)
         return;
+    if (!runOutputLine.isEmpty()) {
+        trackObjective(runOutputLine);
+        runOutputLine.clear();
+    }
+    if (!solverTimedOut && project.memoryLimit() > 0 &&
+        (exitcode != 0 || process->exitStatus()==QProcess::CrashExit)) {
+        addMessage("The solver terminated abnormally while running with a memory limit of "+
+                   QString().number(project.memoryLimit())+" MB. The memory limit was probably exceeded.", OutputConsole::Error);
+    }
     procFinished(exitcode);
 }
 
@@ -1539,10 +1745,19 @@ QString MainWindow::zincTarget(QString srcpath) {
 
 bool MainWindow::targetIsUpToDate() {
     if (curEditor && curEditor->filepath!="") {
-        QFileInfo srcInfo(curEditor->filepath);
         QFileInfo targetInfo(zincTarget(curEditor->filepath));
-        // XXX need to check included zinc files as well
-        return targetInfo.exists() && targetInfo.lastModified() >= srcInfo.lastModified();
+        if (!targetInfo.exists())
+            return false;
+        QStringList closure;
+        QByteArray fingerprint =
+                ModelFingerprint::compute(curEditor->filepath, QStringList(), parseCompileConf(), &closure);
+        QHash<QString,QByteArray>::const_iterator it =
+                compiledFingerprints.find(targetInfo.absoluteFilePath());
+        if (it != compiledFingerprints.end())
+            return it.value()==fingerprint;
+        // Compiled in an earlier session, so compare with the modification
+        // times of the model and all files it includes
+        return targetInfo.lastModified() >= ModelFingerprint::lastModified(closure);
     } else {
         return false;
     }
@@ -1574,6 +1789,7 @@ void MainWindow::on_actionRun_triggered()
             return;
         currentZincTarget = zincTarget(curEditor->filepath);
         on_actionSplit_triggered();
+        clearProblems();
         if (!targetIsUpToDate()) {
             compileOnly = false;
             startCompileZinc(curEditor->filepath);
@@ -1601,7 +1817,6 @@ QString MainWindow::setElapsedTime()
         elapsed += " "+QString().number(msec)+"msec";
 
     QString timeLimit;
-    /*
     if (project.timeLimit() > 0) {
         timeLimit += " / ";
         int tl_hours = project.timeLimit() / 3600;
@@ -1613,7 +1828,6 @@ QString MainWindow::setElapsedTime()
             timeLimit += QString().number(tl_minutes)+"m ";
         timeLimit += QString().number(tl_seconds)+"s";
     }
-    */
     statusLabel->setText(elapsed+timeLimit);
     return elapsed;
 }
@@ -1625,21 +1839,25 @@ void MainWindow::statusTimerEvent()
     ui->statusbar->showMessage(txt);
     time = (time+1) % 5;
     setElapsedTime();
+    if (process)
+        processMonitor->sample(process->processId());
 }
 
 void MainWindow::readOutput()
 {
+    TRACE_SPAN("MainWindow::readOutput");
     MznProcess* readProc = (outputProcess==NULL ? process : outputProcess);
 
     if (readProc != NULL) {
         readProc->setReadChannel(QProcess::StandardOutput);
         while (readProc->canReadLine()) {
             QString l = readProc->readLine();
+            trackObjective(l);
             if (inJSONHandler) {
                 l = l.trimmed();
                 if (l.startsWith("%%%mzn-json-time")) {
                     JSONOutput[curJSONHandler].insert(2, "[");
-                    JSONOutput[curJSONHandler].append(","+ QString().number(elapsedTime.elapsed()) +"]\n");
+                    JSONOutput[curJSONHandler].append(","+ QString().number(solutionTime) +"]\n");
                 } else
                     if (l.startsWith("%%%mzn-json-end")) {
                     curJSONHandler++;
@@ -1665,15 +1883,15 @@ void MainWindow::readOutput()
                         JSONOutput.clear();
                         curJSONHandler = 0;
                         if (hadNonJSONOutput)
-                            addOutput(l,false);
+                            addOutput(l);
                     } else if (curHtmlWindow && l.trimmed() == "==========") {
                         finishJSONViewer();
                         if (hadNonJSONOutput)
-                            addOutput(l,false);
+                            addOutput(l);
                     } else {
                         if (outputBuffer)
                             (*outputBuffer) << l;
-                        addOutput(l,false);
+                        addOutput(l);
                         hadNonJSONOutput = true;
                     }
                 }
@@ -1694,17 +1912,9 @@ void MainWindow::readOutput()
             } else {
                 break;
             }
-            QRegExp errexp("^(.*):([0-9]+):\\s*$");
-            if (errexp.indexIn(l) != -1) {
-                QString errFile = errexp.cap(1).trimmed();
-                QUrl url = QUrl::fromLocalFile(errFile);
-                url.setQuery("line="+errexp.cap(2));
-                url.setScheme("err");
-                IDE::instance()->stats.errorsShown++;
-                addOutput("<a style='color:red' href='"+url.toString()+"'>"+errexp.cap(1)+":"+errexp.cap(2)+":</a><br>");
-            } else {
-                addOutput(l,false);
-            }
+            QStringList lines = stderrParser.lines(l);
+            for (int i=0; i<lines.size(); i++)
+                addDiagnosticLine(lines[i], process->workingDirectory());
         }
     }
 
@@ -1721,7 +1931,7 @@ void MainWindow::readOutput()
             } else {
                 break;
             }
-            addOutput(l,false);
+            addOutput(l);
         }
     }
 }
@@ -1741,15 +1951,21 @@ void MainWindow::openJSONViewer(void)
             url.remove(QRegExp("[\\n\\t\\r]"));
             specs.append(VisWindowSpec(url,area));
         }
-        curHtmlWindow = new HTMLWindow(specs, this);
+        delete solutionStore;
+        solutionStore = new SolutionStore(specs.size());
+        ui->actionExport_solutions->setEnabled(true);
+        curHtmlWindow = new HTMLWindow(specs, this, solutionStore);
         connect(curHtmlWindow, SIGNAL(closeWindow()), this, SLOT(closeHTMLWindow()));
         curHtmlWindow->show();
     }
+    QStringList solution;
     for (int i=0; i<JSONOutput.size(); i++) {
         JSONOutput[i].pop_front();
         JSONOutput[i].pop_front();
-        curHtmlWindow->addSolution(i, JSONOutput[i].join(' '));
+        solution.append(JSONOutput[i].join(' '));
     }
+    solutionStore->append(solution);
+    curHtmlWindow->solutionsAdded();
 }
 
 void MainWindow::finishJSONViewer(void)
@@ -1761,6 +1977,7 @@ void MainWindow::finishJSONViewer(void)
 
 void MainWindow::compileAndRun(const QString& modelPath, const QString& additionalCmdlineParams, const QString& additionalDataFile)
 {
+    clearProblems();
     process = new MznProcess(this);
     processName = zinc_executable;
     curFilePath = modelPath;
@@ -1806,7 +2023,7 @@ void MainWindow::compileAndRun(const QString& modelPath, const QString& addition
         if (!additionalCmdlineParams.isEmpty()) {
             compiling += ", additional arguments " + additionalCmdlineParams;
         }
-        addOutput("<div style='color:blue;'>Compiling "+compiling+"</div><br>");
+        addMessage("Compiling "+compiling);
         process->start(zinc_executable,args,getZincDistribPath());
         time = 0;
         timer->start(500);
@@ -1857,6 +2074,30 @@ void MainWindow::closeHTMLWindow(void)
     curHtmlWindow = NULL;
 }
 
+void MainWindow::on_actionExport_solutions_triggered()
+{
+    if (solutionStore==NULL || solutionStore->size()==0) {
+        QMessageBox::information(this,"MiniZinc IDE","There are no solutions to export.",
+                                 QMessageBox::Ok);
+        return;
+    }
+    QString selectedFilter;
+    QString filepath = QFileDialog::getSaveFileName(this,"Export solutions",getLastPath(),
+                                                    "CSV files (*.csv);;JSON Lines files (*.jsonl)",
+                                                    &selectedFilter);
+    if (filepath.isEmpty())
+        return;
+    setLastPath(QFileInfo(filepath).absolutePath()+fileDialogSuffix);
+    bool jsonLines = filepath.endsWith(".jsonl") ||
+                     (!filepath.endsWith(".csv") && selectedFilter.startsWith("JSON"));
+    bool ok = jsonLines ? solutionStore->exportJSONLines(filepath)
+                        : solutionStore->exportCSV(filepath);
+    if (!ok) {
+        QMessageBox::warning(this,"MiniZinc IDE","Could not write file "+filepath+".",
+                             QMessageBox::Ok);
+    }
+}
+
 void MainWindow::selectJSONSolution(HTMLPage* source, int n)
 {
     if (curHtmlWindow!=NULL) {
@@ -1870,7 +2111,9 @@ void MainWindow::pipeOutput()
 }
 
 void MainWindow::procFinished(int, bool showTime) {
+    TRACE_SPAN("MainWindow::procFinished");
     readOutput();
+    problemsPanel->flush();
     fakeRunAction->setEnabled(false);
     ui->actionRun->setEnabled(true);
     fakeCompileAction->setEnabled(false);
@@ -1880,6 +2123,8 @@ void MainWindow::procFinished(int, bool showTime) {
     ui->configuration->setEnabled(true);
     ui->actionSubmit_to_Coursera->setEnabled(true);
     timer->stop();
+    solverTimeout->stop();
+    solverKillTimer->stop();
     QString elapsedTime = setElapsedTime();
     ui->statusbar->showMessage("Ready.");
     process = NULL;
@@ -1892,8 +2137,15 @@ void MainWindow::procFinished(int, bool showTime) {
         JSONOutput.clear();
     }
     if (showTime) {
-        addOutput("<div style='color:blue;'>Finished in "+elapsedTime+"</div><br>");
+        QString usage;
+        if (processMonitor->hasSamples()) {
+            usage = " (peak memory "+ProcessMonitor::formatBytes(processMonitor->peakRss())+
+                    ", peak CPU "+QString().number(processMonitor->peakCpu())+"%, "+
+                    QString().number(processMonitor->peakThreads())+" threads)";
+        }
+        addMessage("Finished in "+elapsedTime+usage);
     }
+    processMonitor->hide();
     delete tmpDir;
     tmpDir = NULL;
     outputBuffer = NULL;
@@ -1920,6 +2172,7 @@ void MainWindow::outputProcError(QProcess::ProcessError e) {
 
 void MainWindow::saveFile(CodeEditor* ce, const QString& f)
 {
+    TRACE_SPAN("MainWindow::saveFile");
     QString filepath = f;
     int tabIndex = ui->tabWidget->indexOf(ce);
     if (filepath=="") {
@@ -1980,7 +2233,10 @@ void MainWindow::fileRenamed(const QString& oldPath, const QString& newPath)
             if (ce->filepath==oldPath) {
                 ce->filepath = newPath;
                 ce->filename = QFileInfo(newPath).fileName();
-                IDE::instance()->renameFile(oldPath,newPath);
+                // A hibernated editor has released its document, and wakes
+                // up with the file under its new name
+                if (!ce->hibernated)
+                    IDE::instance()->renameFile(oldPath,newPath);
                 ui->tabWidget->setTabText(i,ce->filename);
                 updateRecentFiles(newPath);
                 if (ce==curEditor)
@@ -2005,6 +2261,54 @@ void MainWindow::on_actionSave_as_triggered()
     }
 }
 
+void MainWindow::on_actionExport_triggered()
+{
+    if (curEditor==NULL)
+        return;
+    QString selectedFilter;
+    QString filepath = QFileDialog::getSaveFileName(this,"Export "+curEditor->filename,getLastPath(),
+                                                    "HTML files (*.html);;RTF files (*.rtf);;PDF files (*.pdf)",
+                                                    &selectedFilter);
+    if (filepath.isEmpty())
+        return;
+    setLastPath(QFileInfo(filepath).absolutePath()+fileDialogSuffix);
+    QString suffix = QFileInfo(filepath).suffix().toLower();
+    DocumentExporter::Format format;
+    if (suffix=="html" || suffix=="htm") {
+        format = DocumentExporter::HTML;
+    } else if (suffix=="rtf") {
+        format = DocumentExporter::RTF;
+    } else if (suffix=="pdf") {
+        format = DocumentExporter::PDF;
+    } else if (selectedFilter.startsWith("RTF")) {
+        format = DocumentExporter::RTF;
+    } else if (selectedFilter.startsWith("PDF")) {
+        format = DocumentExporter::PDF;
+    } else {
+        format = DocumentExporter::HTML;
+    }
+    // The exporter works on a snapshot, so editing can continue while it runs
+    const QVector<QTextCharFormat>& formats = curEditor->tokenFormats();
+    DocumentExporter* exporter =
+            new DocumentExporter(curEditor->document()->toPlainText(), formats,
+                                 curEditor->document()->defaultFont(), curEditor->filename, filepath, format, this);
+    connect(exporter, SIGNAL(exported(bool,QString)), this, SLOT(exportFinished(bool,QString)));
+    connect(exporter, SIGNAL(finished()), exporter, SLOT(deleteLater()));
+    exporter->start();
+    statusBar()->showMessage("Exporting "+curEditor->filename+"...");
+}
+
+void MainWindow::exportFinished(bool ok, const QString& fileName)
+{
+    if (ok) {
+        statusBar()->showMessage("Exported "+fileName, 5000);
+    } else {
+        statusBar()->clearMessage();
+        QMessageBox::warning(this,"MiniZinc IDE","Could not export to file "+fileName+".",
+                             QMessageBox::Ok);
+    }
+}
+
 void MainWindow::on_actionQuit_triggered()
 {
     qApp->closeAllWindows();
@@ -2016,28 +2320,47 @@ void MainWindow::on_actionQuit_triggered()
 void MainWindow::on_actionStop_triggered()
 {
     if (process) {
-        disconnect(process, SIGNAL(error(QProcess::ProcessError)),
-                   this, SLOT(procError(QProcess::ProcessError)));
+        disconnect(process, 0, this, 0);
         processWasStopped = true;
 
-#ifdef Q_OS_WIN
-        AttachConsole(process->pid()->dwProcessId);
-        SetConsoleCtrlHandler(NULL, TRUE);
-        GenerateConsoleCtrlEvent(CTRL_C_EVENT, 0);
-#else
-        ::kill(process->pid(), SIGINT);
-#endif
-        if (!process->waitForFinished(100)) {
-            process->kill();
-            process->waitForFinished();
-        }
-        delete process;
+        // The process stops itself asynchronously (including all processes
+        // it has spawned) and is deleted once it is gone
+        connect(process, SIGNAL(stopped(bool)), this, SLOT(processStopped(bool)));
+        process->stop();
         process = NULL;
-        addOutput("<div style='color:blue;'>Stopped.</div><br>");
+        addMessage("Stopped.");
         procFinished(0);
     }
 }
 
+void MainWindow::processStopped(bool clean)
+{
+    if (!clean) {
+        addMessage("Warning: some processes started by the solver could not be stopped.", OutputConsole::Error);
+    }
+    sender()->deleteLater();
+}
+
+void MainWindow::solverTimeLimitExceeded()
+{
+    if (process) {
+        solverTimedOut = true;
+        addMessage("Time limit of "+QString().number(project.timeLimit())+
+                   "s exceeded, interrupting solver.", OutputConsole::Error);
+        // Give the solver a chance to print its best solution before killing it
+        process->interrupt();
+        solverKillTimer->start(5000);
+    }
+}
+
+void MainWindow::solverGracePeriodExpired()
+{
+    if (process) {
+        addMessage("Solver did not react to interrupt, killing it.", OutputConsole::Error);
+        process->killGroup();
+    }
+}
+
 //void MainWindow::runZincModel(int exitcode)
 //{
 //    if (processWasStopped)
@@ -2047,14 +2370,14 @@ void MainWindow::on_actionStop_triggered()
 //        QStringList args = parseConf(false,true);
 //
 //        if (true) {
-//            addOutput("<div style='color:blue;'>Running "+curEditor->filename+" (detached)</div><br>");
+//            addMessage("Running "+curEditor->filename+" (detached)");
 //
 //            MznProcess* detached_process = new MznProcess(this);
 //            detached_process->setWorkingDirectory(QFileInfo(curEditor->filepath).absolutePath());
 //
 //            QString executable = currentZincTarget;
 //            if (project.solverVerbose()) {
-//                addOutput("<div style='color:blue;'>Command line:</div><br>");
+//                addMessage("Command line:");
 //                QString cmdline = executable;
 //                QRegExp white("\\s");
 //                for (int i=0; i<args.size(); i++) {
@@ -2063,7 +2386,7 @@ void MainWindow::on_actionStop_triggered()
 //                    else
 //                        cmdline += " "+args[i];
 //                }
-//                addOutput("<div>"+cmdline+"</div><br>");
+//                addMessage(cmdline, OutputConsole::Plain);
 //            }
 //            detached_process->start(executable,args,getZincDistribPath());
 //            cleanupTmpDirs.append(tmpDir);
@@ -2093,10 +2416,10 @@ void MainWindow::on_actionStop_triggered()
 //            */
 //
 //            elapsedTime.start();
-//            addOutput("<div style='color:blue;'>Running "+QFileInfo(curFilePath).fileName()+"</div><br>");
+//            addMessage("Running "+QFileInfo(curFilePath).fileName());
 //            QString executable = currentZincTarget;
 //            if (project.solverVerbose()) {
-//                addOutput("<div style='color:blue;'>Command line:</div><br>");
+//                addMessage("Command line:");
 //                QString cmdline = executable;
 //                QRegExp white("\\s");
 //                for (int i=0; i<args.size(); i++) {
@@ -2105,7 +2428,7 @@ void MainWindow::on_actionStop_triggered()
 //                    else
 //                        cmdline += " "+args[i];
 //                }
-//                addOutput("<div>"+cmdline+"</div><br>");
+//                addMessage(cmdline, OutputConsole::Plain);
 //            }
 //            process->start(executable,args,getZincDistribPath());
 //            time = 0;
@@ -2152,25 +2475,19 @@ void MainWindow::on_actionCompile_triggered()
         ui->actionSubmit_to_Coursera->setEnabled(false);
 
         compileOnly = true;
+        clearProblems();
         startCompileZinc(curEditor->filepath);
     }
 }
 
 void MainWindow::on_actionClear_output_triggered()
 {
-    ui->outputConsole->document()->clear();
+    ui->outputConsole->clear();
 }
 
 void MainWindow::setEditorFont(QFont font)
 {
-    QTextCharFormat format;
-    format.setFont(font);
-
     ui->outputConsole->setFont(font);
-    QTextCursor cursor(ui->outputConsole->document());
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
-    cursor.mergeCharFormat(format);
     for (int i=0; i<ui->tabWidget->count(); i++) {
         if (ui->tabWidget->widget(i)!=ui->configuration) {
             CodeEditor* ce = static_cast<CodeEditor*>(ui->tabWidget->widget(i));
@@ -2179,22 +2496,37 @@ void MainWindow::setEditorFont(QFont font)
     }
 }
 
+void MainWindow::changeEditorFont(const QFont& font)
+{
+    // The font is the default font of the documents, which are shared
+    // between windows, so it cannot differ from window to window
+    Settings::instance()->setValue("MainWindow/editorFont", font);
+    for (QSet<MainWindow*>::iterator it = IDE::instance()->mainWindows.begin();
+         it != IDE::instance()->mainWindows.end(); ++it) {
+        (*it)->editorFont = font;
+        (*it)->setEditorFont(font);
+    }
+}
+
 void MainWindow::on_actionBigger_font_triggered()
 {
-    editorFont.setPointSize(editorFont.pointSize()+1);
-    setEditorFont(editorFont);
+    QFont font = editorFont;
+    font.setPointSize(font.pointSize()+1);
+    changeEditorFont(font);
 }
 
 void MainWindow::on_actionSmaller_font_triggered()
 {
-    editorFont.setPointSize(std::max(5, editorFont.pointSize()-1));
-    setEditorFont(editorFont);
+    QFont font = editorFont;
+    font.setPointSize(std::max(5, font.pointSize()-1));
+    changeEditorFont(font);
 }
 
 void MainWindow::on_actionDefault_font_size_triggered()
 {
-    editorFont.setPointSize(13);
-    setEditorFont(editorFont);
+    QFont font = editorFont;
+    font.setPointSize(13);
+    changeEditorFont(font);
 }
 
 void MainWindow::on_actionAbout_MiniZinc_IDE_triggered()
@@ -2202,6 +2534,18 @@ void MainWindow::on_actionAbout_MiniZinc_IDE_triggered()
     AboutDialog(IDE::instance()->applicationVersion()).exec();
 }
 
+void MainWindow::on_outputFilter_textChanged(const QString& text)
+{
+    ui->outputConsole->setFilter(text);
+}
+
+void MainWindow::on_outputFind_returnPressed()
+{
+    bool backward = QApplication::keyboardModifiers() & Qt::ShiftModifier;
+    if (!ui->outputConsole->find(ui->outputFind->text(), backward))
+        ui->statusbar->showMessage("\""+ui->outputFind->text()+"\" not found in output.", 2000);
+}
+
 void MainWindow::errorClicked(const QUrl & url)
 {
     IDE::instance()->stats.errorsClicked++;
@@ -2214,6 +2558,8 @@ void MainWindow::errorClicked(const QUrl & url)
                     bool ok;
                     int line = re_line.cap(1).toInt(&ok);
                     if (ok) {
+                        if (ce->hibernated)
+                            wakeEditor(ce);
                         QTextBlock block = ce->document()->findBlockByNumber(line-1);
                         if (block.isValid()) {
                             QTextCursor cursor = ce->textCursor();
@@ -2230,6 +2576,82 @@ void MainWindow::errorClicked(const QUrl & url)
     }
 }
 
+void MainWindow::problemActivated(const QString& file, int line, int)
+{
+    QUrl url = QUrl::fromLocalFile(file);
+    url.setQuery("line="+QString().number(line));
+    url.setScheme("err");
+    errorClicked(url);
+}
+
+void MainWindow::insertLibraryCall(const QString& text)
+{
+    if (curEditor==NULL || curEditor->isReadOnly())
+        return;
+    curEditor->textCursor().insertText(text);
+    curEditor->setFocus();
+}
+
+void MainWindow::libraryDockVisibilityChanged(bool visible)
+{
+    // Pick up libraries that were installed or changed since the last update
+    if (visible)
+        updateLibraryIndex();
+}
+
+void MainWindow::libraryIndexUpdated(void)
+{
+    QStringList names;
+    for (int i=0; i<libraryIndex->size(); i++) {
+        // Entries are sorted by name, so overloads are adjacent
+        const QString& name = libraryIndex->entry(i).name;
+        if (names.isEmpty() || names.last() != name)
+            names.append(name);
+    }
+    CompletionIndex::instance()->setLibrary(names);
+}
+
+void MainWindow::updateLibraryIndex(void)
+{
+    QString distrib = getZincDistribPath();
+    if (distrib.isEmpty())
+        distrib = QFileInfo(QStandardPaths::findExecutable(zinc_executable)).absolutePath();
+    libraryIndex->update(LibraryIndex::libraryDirs(distrib, solvers));
+}
+
+void MainWindow::updateProblemMarkers(const QStringList& files)
+{
+    // Only the first diagnostics of a file are marked, as thousands of
+    // markers would make every cursor movement slow
+    static const int maxMarkers = 200;
+    QSet<QString> changed = files.toSet();
+    for (int i=0; i<ui->tabWidget->count(); i++) {
+        if (ui->tabWidget->widget(i) == ui->configuration)
+            continue;
+        CodeEditor* ce = static_cast<CodeEditor*>(ui->tabWidget->widget(i));
+        if (ce->filepath.isEmpty() || !changed.contains(ce->filepath))
+            continue;
+        QVector<DiagnosticParser::Diagnostic> ds = problemsPanel->diagnosticsFor(ce->filepath);
+        // New diagnostics only ever change the last one already reported,
+        // so the markers of a file that was over the limit stay the same
+        if (problemMarkerSources.value(ce->filepath) > maxMarkers && ds.size() > maxMarkers)
+            continue;
+        QVector<CodeEditor::Diagnostic> markers;
+        for (int j=0; j<ds.size() && j<maxMarkers; j++) {
+            markers.append(CodeEditor::Diagnostic(ds[j].line-1, std::max(0, ds[j].col-1), ds[j].message,
+                                                  ds[j].severity != DiagnosticParser::Error));
+        }
+        ce->setDiagnostics(markers, CodeEditor::RunDiagnostics);
+    }
+    for (int i=0; i<files.size(); i++) {
+        int n = problemsPanel->diagnosticsFor(files[i]).size();
+        if (n==0)
+            problemMarkerSources.remove(files[i]);
+        else
+            problemMarkerSources.insert(files[i], n);
+    }
+}
+
 void MainWindow::on_actionFind_triggered()
 {
     findDialog->raise();
@@ -2249,8 +2671,7 @@ void MainWindow::on_actionSelect_font_triggered()
     bool ok;
     QFont newFont = QFontDialog::getFont(&ok,editorFont,this);
     if (ok) {
-        editorFont = newFont;
-        setEditorFont(editorFont);
+        changeEditorFont(newFont);
     }
 }
 
@@ -2289,36 +2710,163 @@ void MainWindow::checkMznPath()
 
 void MainWindow::on_actionShift_left_triggered()
 {
-    QTextCursor cursor = curEditor->textCursor();
-    QTextBlock block = curEditor->document()->findBlock(cursor.anchor());
-    QRegExp white("\\s");
-    QTextBlock endblock = curEditor->document()->findBlock(cursor.position()).next();
-    cursor.beginEditBlock();
-    do {
-        cursor.setPosition(block.position());
-        if (block.length() > 2) {
-            cursor.movePosition(QTextCursor::Right,QTextCursor::KeepAnchor,2);
-            if (white.indexIn(cursor.selectedText()) == 0) {
-                cursor.removeSelectedText();
+    curEditor->shiftLeft();
+}
+
+void MainWindow::on_actionShift_right_triggered()
+{
+    curEditor->shiftRight();
+}
+
+void MainWindow::loadSolvers(void)
+{
+    Solver g12fd("G12 fd","flatzinc","-Gg12_fd","",true,false);
+    bool hadg12fd = false;
+    Solver g12lazyfd("G12 lazyfd","flatzinc","-Gg12_lazyfd","-b lazy",true,false);
+    bool hadg12lazyfd = false;
+    Solver g12mip("G12 MIP","flatzinc","-Glinear","-b mip",true,false);
+    bool hadg12mip = false;
+
+#ifdef MINIZINC_IDE_BUNDLED
+    Solver gecode("Gecode (bundled)","fzn-gecode","-Ggecode","",true,false);
+    bool hadgecode = false;
+    Solver gecodeGist("Gecode (Gist, bundled)","fzn-gecode-gist","-Ggecode","",true,true);
+    bool hadgecodegist = false;
+#endif
+
+    const QVector<Solver>& saved = Settings::instance()->solvers();
+    solvers.clear();
+    if (saved.isEmpty()) {
+#ifdef MINIZINC_IDE_BUNDLED
+        solvers.append(gecode);
+        solvers.append(gecodeGist);
+#endif
+        solvers.append(g12fd);
+        solvers.append(g12lazyfd);
+        solvers.append(g12mip);
+    } else {
+        IDE::instance()->stats.solvers.clear();
+        for (int i=0; i<saved.size(); i++) {
+            Solver solver = saved[i];
+            if (solver.builtin) {
+                if (solver.name=="G12 fd") {
+                    solver = g12fd;
+                    hadg12fd = true;
+                } else if (solver.name=="G12 lazyfd") {
+                    solver = g12lazyfd;
+                    hadg12lazyfd = true;
+                } else if (solver.name=="G12 MIP") {
+                    solver = g12mip;
+                    hadg12mip = true;
+                }
+#ifdef MINIZINC_IDE_BUNDLED
+                else if (solver.name=="Gecode (bundled)") {
+                    solver = gecode;
+                    hadgecode = true;
+                }
+                else if (solver.name=="Gecode (Gist, bundled)") {
+                    solver = gecodeGist;
+                    hadgecodegist = true;
+                }
+#endif
+            } else {
+                IDE::instance()->stats.solvers.append(solver.name);
             }
+            solvers.append(solver);
         }
-        block = block.next();
-    } while (block.isValid() && block != endblock);
-    cursor.endEditBlock();
+        if (!hadg12fd)
+            solvers.append(g12fd);
+        if (!hadg12lazyfd)
+            solvers.append(g12lazyfd);
+        if (!hadg12mip)
+            solvers.append(g12mip);
+#ifdef MINIZINC_IDE_BUNDLED
+        if (!hadgecodegist)
+            solvers.push_front(gecodeGist);
+        if (!hadgecode)
+            solvers.push_front(gecode);
+#endif
+    }
 }
 
-void MainWindow::on_actionShift_right_triggered()
+void MainWindow::on_actionFold_arrays_triggered()
+{
+    if (curEditor==NULL)
+        return;
+    Settings* settings = Settings::instance();
+    bool ok;
+    int minLines = QInputDialog::getInt(this, "Fold arrays",
+                                        "Fold all arrays spanning more than this number of lines:",
+                                        settings->value("MainWindow/foldArrayLines",10).toInt(), 1, 1000000, 1, &ok);
+    if (ok) {
+        settings->setValue("MainWindow/foldArrayLines", minLines);
+        curEditor->foldArrays(minLines);
+    }
+}
+
+void MainWindow::on_actionUnfold_all_triggered()
+{
+    if (curEditor)
+        curEditor->unfoldAll();
+}
+
+void MainWindow::on_actionHibernate_tabs_triggered()
 {
-    QTextCursor cursor = curEditor->textCursor();
-    QTextBlock block = curEditor->document()->findBlock(cursor.anchor());
-    QTextBlock endblock = curEditor->document()->findBlock(cursor.position()).next();
-    cursor.beginEditBlock();
-    do {
-        cursor.setPosition(block.position());
-        cursor.insertText("  ");
-        block = block.next();
-    } while (block.isValid() && block != endblock);
-    cursor.endEditBlock();
+    Settings* settings = Settings::instance();
+    bool ok;
+    int minutes = QInputDialog::getInt(this, "Hibernate idle tabs",
+                                       "Release unmodified background tabs after this many minutes (0 = never):",
+                                       settings->value("MainWindow/hibernateAfterMinutes", 60).toInt(), 0, 100000, 1, &ok);
+    if (!ok)
+        return;
+    int budget = QInputDialog::getInt(this, "Hibernate idle tabs",
+                                      "Release the least recently viewed tabs while open documents\n"
+                                      "use more than this many megabytes (0 = no limit):",
+                                      settings->value("MainWindow/documentMemoryMB", 0).toInt(), 0, 1000000, 16, &ok);
+    if (!ok)
+        return;
+    settings->setValue("MainWindow/hibernateAfterMinutes", minutes);
+    settings->setValue("MainWindow/documentMemoryMB", budget);
+    IDE::instance()->hibernateTabs();
+}
+
+void MainWindow::hibernateEditor(CodeEditor* ce)
+{
+    ce->hibernatedAnchor = ce->textCursor().anchor();
+    ce->hibernatedPosition = ce->textCursor().position();
+    ce->hibernatedScroll = ce->verticalScrollBar()->value();
+    ce->hibernatedHScroll = ce->horizontalScrollBar()->value();
+    // An empty placeholder keeps the editor valid while the document,
+    // with its layouts, formats and block data, is released
+    QTextDocument* placeholder = new QTextDocument(ce);
+    placeholder->setDocumentLayout(new QPlainTextDocumentLayout(placeholder));
+    ce->setDocument(placeholder);
+    IDE::instance()->removeEditor(ce->filepath, ce);
+    ce->hibernated = true;
+}
+
+void MainWindow::wakeEditor(CodeEditor* ce)
+{
+    ce->hibernated = false;
+    QPair<QTextDocument*,bool> d = IDE::instance()->loadFile(ce->filepath, this);
+    if (d.first == NULL) {
+        // The file has gone, keep the tab as an empty untitled document
+        ce->filepath = "";
+        return;
+    }
+    QTextDocument* placeholder = ce->document();
+    ce->setDocument(d.first);
+    delete placeholder;
+    IDE::instance()->registerEditor(ce->filepath, ce);
+    if (d.second)
+        IDE::instance()->loadLargeFile(ce->filepath, this);
+    int last = std::max(0, d.first->characterCount()-1);
+    QTextCursor cursor(d.first);
+    cursor.setPosition(std::min(ce->hibernatedAnchor, last));
+    cursor.setPosition(std::min(ce->hibernatedPosition, last), QTextCursor::KeepAnchor);
+    ce->setTextCursor(cursor);
+    ce->verticalScrollBar()->setValue(ce->hibernatedScroll);
+    ce->horizontalScrollBar()->setValue(ce->hibernatedHScroll);
 }
 
 void MainWindow::on_actionHelp_triggered()
@@ -2448,7 +2996,7 @@ void MainWindow::saveProject(const QString& f)
             tabChange(ui->tabWidget->currentIndex());
             QDataStream out(&file);
             out << (quint32)0xD539EA12;
-            out << (quint32)103;
+            out << (quint32)104;
             out.setVersion(QDataStream::Qt_5_0);
             QStringList openFiles;
             QDir projectDir = QFileInfo(filepath).absoluteDir();
@@ -2479,6 +3027,8 @@ void MainWindow::saveProject(const QString& f)
                 projectFilesRelPath << projectDir.relativeFilePath(*it);
             }
             out << projectFilesRelPath;
+            out << (qint32)project.timeLimit();
+            out << (qint32)project.memoryLimit();
             project.setModified(false, true);
 
         } else {
@@ -2502,7 +3052,7 @@ void MainWindow::loadProject(const QString& filepath)
     }
     quint32 version;
     in >> version;
-    if (version != 101 && version != 102 && version != 103) {
+    if (version != 101 && version != 102 && version != 103 && version != 104) {
         QMessageBox::warning(this, "MiniZinc IDE",
                              "Could not open project file (version mismatch)");
         close();
@@ -2514,7 +3064,7 @@ void MainWindow::loadProject(const QString& filepath)
     updateRecentProjects(projectPath);
     project.setRoot(ui->projectView, projectSort, projectPath);
     QString basePath;
-    if (version==103) {
+    if (version>=103) {
         basePath = QFileInfo(filepath).absolutePath()+"/";
     }
 
@@ -2532,6 +3082,8 @@ void MainWindow::loadProject(const QString& filepath)
     project.haveZincArgs(p_b, true);
     in >> p_s;
     project.zincArgs(p_s, true);
+    in >> p_i;
+    project.n_solutions(p_i, true);
     in >> p_b;
     project.printAll(p_b, true);
     in >> p_b;
@@ -2546,6 +3098,15 @@ void MainWindow::loadProject(const QString& filepath)
     ui->tabWidget->setCurrentIndex(p_i);
     QStringList projectFilesRelPath;
     in >> projectFilesRelPath;
+    if (version >= 104) {
+        in >> p_i;
+        project.timeLimit(p_i, true);
+        in >> p_i;
+        project.memoryLimit(p_i, true);
+    } else {
+        project.timeLimit(0, true);
+        project.memoryLimit(0, true);
+    }
     for (int i=0; i<projectFilesRelPath.size(); i++) {
         QFileInfo fi(basePath+projectFilesRelPath[i]);
         if (fi.exists()) {
@@ -2608,48 +3169,12 @@ void MainWindow::on_actionSave_all_triggered()
 
 void MainWindow::on_action_Un_comment_triggered()
 {
-    QTextCursor cursor = curEditor->textCursor();
-    QTextBlock beginBlock = curEditor->document()->findBlock(cursor.anchor());
-    QTextBlock endblock = curEditor->document()->findBlock(cursor.position());
-    if (beginBlock.blockNumber() > endblock.blockNumber())
-        std::swap(beginBlock,endblock);
-    endblock = endblock.next();
-
-    QRegExp comment("^(\\s*%|\\s*$)");
-    QRegExp comSpace("%\\s");
-    QRegExp emptyLine("^\\s*$");
-
-    QTextBlock block = beginBlock;
-    bool isCommented = true;
-    do {
-        if (comment.indexIn(block.text()) == -1) {
-            isCommented = false;
-            break;
-        }
-        block = block.next();
-    } while (block.isValid() && block != endblock);
-
-    block = beginBlock;
-    cursor.beginEditBlock();
-    do {
-        cursor.setPosition(block.position());
-        QString t = block.text();
-        if (isCommented) {
-            int cpos = t.indexOf("%");
-            if (cpos != -1) {
-                cursor.setPosition(block.position()+cpos);
-                bool haveSpace = (comSpace.indexIn(t,cpos)==cpos);
-                cursor.movePosition(QTextCursor::Right,QTextCursor::KeepAnchor,haveSpace ? 2:1);
-                cursor.removeSelectedText();
-            }
+    curEditor->toggleComment();
+}
 
-        } else {
-            if (emptyLine.indexIn(t)==-1)
-                cursor.insertText("% ");
-        }
-        block = block.next();
-    } while (block.isValid() && block != endblock);
-    cursor.endEditBlock();
+void MainWindow::on_actionReindent_triggered()
+{
+    curEditor->reindent();
 }
 
 void MainWindow::on_actionOnly_editor_triggered()
@@ -2756,9 +3281,6 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *ev)
             if (keyEvent == QKeySequence::Copy) {
                 ui->outputConsole->copy();
                 return true;
-            } else if (keyEvent == QKeySequence::Cut) {
-                ui->outputConsole->cut();
-                return true;
             }
         }
         return false;
@@ -2774,18 +3296,54 @@ void MainWindow::on_actionCheat_Sheet_triggered()
     IDE::instance()->cheatSheet->activateWindow();
 }
 
+void MainWindow::on_actionRecord_performance_trace_toggled(bool enable)
+{
+    if (enable == Trace::isEnabled())
+        return;
+    // Recording is global, so all windows show the same state
+    for (QSet<MainWindow*>::iterator it = IDE::instance()->mainWindows.begin();
+         it != IDE::instance()->mainWindows.end(); ++it) {
+        (*it)->ui->actionRecord_performance_trace->blockSignals(true);
+        (*it)->ui->actionRecord_performance_trace->setChecked(enable);
+        (*it)->ui->actionRecord_performance_trace->blockSignals(false);
+    }
+    Trace::setEnabled(enable);
+    if (enable)
+        return;
+    QString fileName = QFileDialog::getSaveFileName(this, "Save performance trace",
+                                                    getLastPath()+"/minizinc-ide-trace.json",
+                                                    "Trace files (*.json)");
+    if (fileName.isEmpty())
+        return;
+    setLastPath(QFileInfo(fileName).absolutePath()+fileDialogSuffix);
+    if (!Trace::save(fileName))
+        QMessageBox::warning(this, "MiniZinc IDE", "Could not save the performance trace to "+fileName);
+}
+
+void MainWindow::on_actionCheck_in_background_toggled(bool enable)
+{
+    checker->setEnabled(enable);
+    Settings::instance()->setValue("MainWindow/backgroundCheck", enable);
+}
+
 void MainWindow::on_actionDark_mode_toggled(bool enable)
 {
-    darkMode = enable;
-    QSettings settings;
-    settings.beginGroup("MainWindow");
-    settings.setValue("darkMode",darkMode);
-    settings.endGroup();
-    for (int i=0; i<ui->tabWidget->count(); i++) {
-        if (ui->tabWidget->widget(i) != ui->configuration) {
-            CodeEditor* ce = static_cast<CodeEditor*>(ui->tabWidget->widget(i));
-            ce->setDarkMode(darkMode);
+    // The colours are kept in the highlighter of a document, which all its
+    // views share, so the theme applies to all windows
+    Settings::instance()->setValue("MainWindow/darkMode",enable);
+    for (QSet<MainWindow*>::iterator it = IDE::instance()->mainWindows.begin();
+         it != IDE::instance()->mainWindows.end(); ++it) {
+        MainWindow* mw = *it;
+        mw->darkMode = enable;
+        mw->ui->actionDark_mode->blockSignals(true);
+        mw->ui->actionDark_mode->setChecked(enable);
+        mw->ui->actionDark_mode->blockSignals(false);
+        for (int i=0; i<mw->ui->tabWidget->count(); i++) {
+            if (mw->ui->tabWidget->widget(i) != mw->ui->configuration) {
+                CodeEditor* ce = static_cast<CodeEditor*>(mw->ui->tabWidget->widget(i));
+                ce->setDarkMode(enable);
+            }
         }
     }
-    static_cast<CodeEditor*>(IDE::instance()->cheatSheet->centralWidget())->setDarkMode(darkMode);
+    static_cast<CodeEditor*>(IDE::instance()->cheatSheet->centralWidget())->setDarkMode(enable);
 }
@@ -36,6 +36,18 @@
 #include "project.h"
 #include "htmlwindow.h"
 #include "courserasubmission.h"
+#include "processmonitor.h"
+#include "outputconsole.h"
+#include "solutionstore.h"
+#include "convergencechart.h"
+#include "backgroundchecker.h"
+#include "modelfingerprint.h"
+#include "diagnosticparser.h"
+#include "problemspanel.h"
+#include "libraryindex.h"
+#include "librarybrowser.h"
+#include "editjournal.h"
+#include "settings.h"
 
 namespace Ui {
 class MainWindow;
@@ -88,6 +100,7 @@ public:
 #endif
 
     QFileSystemWatcher fsWatch;
+    EditJournal* journal;
 
     bool hasFile(const QString& path);
     QPair<QTextDocument*,bool> loadFile(const QString& path, QWidget* parent);
@@ -96,6 +109,8 @@ public:
     void registerEditor(const QString& path, CodeEditor* ce);
     void removeEditor(const QString& path, CodeEditor* ce);
     void renameFile(const QString& oldPath, const QString& newPath);
+    /// Replace the text of the open documents by the recovered \a texts
+    void restoreDocuments(const QMap<QString,QString>& texts);
     QString appDir(void) const;
     static IDE* instance(void);
     QString getLastPath(void);
@@ -110,6 +125,11 @@ protected slots:
 public slots:
     void checkUpdate(void);
     void help(void);
+    /// Hibernate background tabs that have been idle for too long, or
+    /// while the open documents exceed the memory budget
+    void hibernateTabs(void);
+private:
+    QTimer hibernationTimer;
 };
 
 class MainWindow : public QMainWindow
@@ -175,10 +195,20 @@ private slots:
 
     void statusTimerEvent();
 
+    void solverTimeLimitExceeded();
+
+    void solverGracePeriodExpired();
+
+    void processStopped(bool);
+
     void on_actionCompile_triggered();
 
     void on_actionSave_as_triggered();
 
+    void on_actionExport_triggered();
+
+    void exportFinished(bool ok, const QString& fileName);
+
     void on_actionClear_output_triggered();
 
     void on_actionBigger_font_triggered();
@@ -188,6 +218,17 @@ private slots:
     void on_actionAbout_MiniZinc_IDE_triggered();
 
     void errorClicked(const QUrl&);
+    void problemActivated(const QString& file, int line, int col);
+    void updateProblemMarkers(const QStringList& files);
+    void insertLibraryCall(const QString& text);
+    void libraryDockVisibilityChanged(bool visible);
+    void libraryIndexUpdated(void);
+
+    void on_outputFilter_textChanged(const QString& text);
+
+    void on_outputFind_returnPressed();
+
+    void on_actionExport_solutions_triggered();
 
     void on_actionDefault_font_size_triggered();
 
@@ -203,6 +244,11 @@ private slots:
 
     void on_actionShift_right_triggered();
 
+    void on_actionFold_arrays_triggered();
+
+    void on_actionUnfold_all_triggered();
+    void on_actionHibernate_tabs_triggered();
+
     void on_actionHelp_triggered();
 
     void on_actionNew_project_triggered();
@@ -221,6 +267,8 @@ private slots:
 
     void on_action_Un_comment_triggered();
 
+    void on_actionReindent_triggered();
+
     void on_actionOnly_editor_triggered();
 
     void on_actionSplit_triggered();
@@ -273,6 +321,12 @@ private slots:
 
     void on_actionDark_mode_toggled(bool arg1);
 
+    void on_actionCheck_in_background_toggled(bool enable);
+    /// Pass the current compiler and its arguments to the background checker
+    void updateCheckerConfig(void);
+
+    void on_actionRecord_performance_trace_toggled(bool enable);
+
     void courseraFinished(int);
 
 protected:
@@ -290,6 +344,7 @@ private:
     CodeEditor* curEditor;
     QString curFilePath;
     HTMLWindow* curHtmlWindow;
+    SolutionStore* solutionStore;
     MznProcess* process;
     QString processName;
     MznProcess* outputProcess;
@@ -300,15 +355,41 @@ private:
     QVector<QStringList> JSONOutput;
     QTimer* timer;
     QTimer* solverTimeout;
+    QTimer* solverKillTimer;
+    bool solverTimedOut;
     int time;
     QElapsedTimer elapsedTime;
     QLabel* statusLabel;
+    ProcessMonitor* processMonitor;
+    ConvergenceChart* convergenceChart;
+    BackgroundChecker* checker;
+    QDockWidget* convergenceDock;
+    ProblemsPanel* problemsPanel;
+    QDockWidget* problemsDock;
+    /// Line buffers for the compiler output and the solver's standard error
+    DiagnosticParser compileParser;
+    DiagnosticParser stderrParser;
+    /// Number of following lines that may still continue the last diagnostic's message
+    int problemContinuation;
+    /// Number of diagnostics each file had when its editors' markers were last set
+    QHash<QString,int> problemMarkerSources;
+    LibraryIndex* libraryIndex;
+    QDockWidget* libraryDock;
+    QString runOutputLine;
+    bool haveObjective;
+    double curObjective;
+    /// Time of the %%%mzn-json-time stamp of the current solution, or -1
+    qint64 solutionTime;
     QFont editorFont;
     bool darkMode;
     QVector<Solver> solvers;
     QString zincDistribPath;
     QString getZincDistribPath(void) const;
     QString currentZincTarget;
+    QString compilingTarget;
+    QByteArray compilingFingerprint;
+    /// Fingerprints of the models that targets were last compiled from
+    QHash<QString,QByteArray> compiledFingerprints;
     bool runSolns2Out;
     QTemporaryDir* tmpDir;
     QVector<QTemporaryDir*> cleanupTmpDirs;
@@ -346,16 +427,32 @@ private:
     void saveProject(const QString& filepath);
     void loadProject(const QString& filepath);
     void setEditorFont(QFont font);
+    /// Use \a font in all windows, since views of a document share its font
+    void changeEditorFont(const QFont& font);
     void setLastPath(const QString& s);
     QString getLastPath(void);
     QString setElapsedTime();
+    void trackObjective(const QString& line);
+    /// Show a complete \a line of compiler or solver output, linking and
+    /// collecting it if it is a diagnostic (relative paths are resolved against \a dir)
+    void addDiagnosticLine(const QString& line, const QString& dir);
+    void clearProblems(void);
+    /// Release the document of the background tab \a ce, keeping its cursor and scroll position
+    void hibernateEditor(CodeEditor* ce);
+    /// Reload the document of the hibernated tab \a ce
+    void wakeEditor(CodeEditor* ce);
+    /// Re-index the standard and solver libraries whose files have changed
+    void updateLibraryIndex(void);
+    /// Fill solvers from the saved solver list and the built-in solvers
+    void loadSolvers(void);
     void setupDznMenu();
     void checkMznPath();
     void updateRecentProjects(const QString& p);
     void updateRecentFiles(const QString& p);
     void addFileToProject(bool dznOnly);
 public:
-    void addOutput(const QString& s, bool html=true);
+    void addOutput(const QString& s);
+    void addMessage(const QString& s, OutputConsole::Style style=OutputConsole::Info);
     void openProject(const QString& fileName);
     bool isEmptyProject(void);
     void selectJSONSolution(HTMLPage* source, int n);
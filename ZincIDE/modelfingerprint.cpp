@@ -0,0 +1,68 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "modelfingerprint.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QSet>
+
+QByteArray ModelFingerprint::compute(const QString& modelPath, const QStringList& extraFiles,
+                                     const QStringList& args, QStringList* closure)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QRegExp include("^\\s*include\\s*\"([^\"]+)\"");
+    QStringList todo;
+    todo << QFileInfo(modelPath).absoluteFilePath();
+    QSet<QString> seen;
+    while (!todo.isEmpty()) {
+        QFileInfo fi(todo.takeFirst());
+        QString path = fi.canonicalFilePath();
+        if (path.isEmpty() || seen.contains(path))
+            continue;
+        seen.insert(path);
+        QFile f(path);
+        if (!f.open(QFile::ReadOnly))
+            continue;
+        QByteArray contents = f.readAll();
+        hash.addData(path.toUtf8());
+        hash.addData(contents);
+        if (closure)
+            closure->append(path);
+        // Each file is read only once, for both hashing and finding includes
+        QStringList lines = QString::fromUtf8(contents).split('\n');
+        for (int i=0; i<lines.size(); i++) {
+            if (include.indexIn(lines[i]) != -1) {
+                QString inc = include.cap(1);
+                QFileInfo incInfo(inc);
+                if (incInfo.isRelative())
+                    incInfo = QFileInfo(fi.absoluteDir(), inc);
+                if (incInfo.exists())
+                    todo << incInfo.absoluteFilePath();
+            }
+        }
+    }
+    for (int i=0; i<extraFiles.size(); i++) {
+        QFile f(extraFiles[i]);
+        hash.addData(extraFiles[i].toUtf8());
+        if (f.open(QFile::ReadOnly))
+            hash.addData(f.readAll());
+    }
+    hash.addData(args.join("\n").toUtf8());
+    return hash.result();
+}
+
+QDateTime ModelFingerprint::lastModified(const QStringList& files)
+{
+    QDateTime last;
+    for (int i=0; i<files.size(); i++) {
+        QDateTime m = QFileInfo(files[i]).lastModified();
+        if (!last.isValid() || m > last)
+            last = m;
+    }
+    return last;
+}
@@ -0,0 +1,30 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef MODELFINGERPRINT_H
+#define MODELFINGERPRINT_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QStringList>
+
+/// Identifies a version of a model by the contents of all of its files.
+///
+/// A fingerprint covers the model file, every file it includes (directly
+/// or indirectly) that can be found relative to the including file, any
+/// additional files such as data files, and the command line arguments.
+/// Included files that cannot be found this way (e.g. from the standard
+/// library) are assumed not to change.
+class ModelFingerprint
+{
+public:
+    /// Compute the fingerprint of \a modelPath with \a extraFiles and \a args.
+    /// If \a closure is not NULL, the model and its included files are stored in it.
+    static QByteArray compute(const QString& modelPath, const QStringList& extraFiles,
+                              const QStringList& args, QStringList* closure=NULL);
+    /// The latest modification time of any of \a files
+    static QDateTime lastModified(const QStringList& files);
+};
+
+#endif // MODELFINGERPRINT_H
@@ -0,0 +1,619 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "outputconsole.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const int margin = 4;
+    const int tabWidth = 8;
+    // When the store grows beyond this size, the oldest half of the output is dropped
+    const int maxBytes = 1 << 30;
+
+    inline char lowerAscii(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c+('a'-'A')) : c;
+    }
+
+    inline bool matchAt(const char* p, const QByteArray& needle, bool ci)
+    {
+        if (!ci)
+            return memcmp(p, needle.constData(), needle.size())==0;
+        for (int i=0; i<needle.size(); i++) {
+            if (lowerAscii(p[i]) != needle[i])
+                return false;
+        }
+        return true;
+    }
+
+    /// Offset of the first match of \a needle starting in [from,to], or -1
+    int findForward(const QByteArray& hay, int from, int to, const QByteArray& needle, bool ci)
+    {
+        to = std::min(to, hay.size()-needle.size());
+        const char* d = hay.constData();
+        char first = needle[0];
+        for (int i=std::max(from,0); i<=to; i++) {
+            if ((ci ? lowerAscii(d[i]) : d[i])==first && matchAt(d+i, needle, ci))
+                return i;
+        }
+        return -1;
+    }
+
+    /// Offset of the last match of \a needle starting in [from,to], or -1
+    int findBackward(const QByteArray& hay, int from, int to, const QByteArray& needle, bool ci)
+    {
+        to = std::min(to, hay.size()-needle.size());
+        const char* d = hay.constData();
+        char first = needle[0];
+        for (int i=to; i>=std::max(from,0); i--) {
+            if ((ci ? lowerAscii(d[i]) : d[i])==first && matchAt(d+i, needle, ci))
+                return i;
+        }
+        return -1;
+    }
+
+    /// Encode \a s for byte-wise search. Case insensitive search is only
+    /// supported for ASCII search strings, others are matched exactly.
+    QByteArray searchBytes(const QString& s, Qt::CaseSensitivity cs, bool& ci)
+    {
+        QByteArray b = s.toUtf8();
+        ci = false;
+        if (cs==Qt::CaseInsensitive) {
+            ci = true;
+            for (int i=0; i<b.size(); i++) {
+                if (static_cast<unsigned char>(b[i]) >= 0x80) {
+                    ci = false;
+                    break;
+                }
+            }
+            if (ci) {
+                for (int i=0; i<b.size(); i++)
+                    b[i] = lowerAscii(b[i]);
+            }
+        }
+        return b;
+    }
+}
+
+OutputConsole::OutputConsole(QWidget *parent) :
+    QAbstractScrollArea(parent), _openCols(0), _maxLineBytes(0),
+    _selecting(false), _pressedLink(-1)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    viewport()->setMouseTracking(true);
+    verticalScrollBar()->setSingleStep(1);
+}
+
+int OutputConsole::lineEnd(int i) const
+{
+    return i+1 < _lineStart.size() ? static_cast<int>(_lineStart[i+1])-1 : _data.size();
+}
+
+QString OutputConsole::line(int i) const
+{
+    int start = _lineStart[i];
+    return QString::fromUtf8(_data.constData()+start, lineEnd(i)-start);
+}
+
+int OutputConsole::rowCount(void) const
+{
+    return _filter.isEmpty() ? _lineStart.size() : _rows.size();
+}
+
+int OutputConsole::lineOfRow(int row) const
+{
+    return _filter.isEmpty() ? row : static_cast<int>(_rows[row]);
+}
+
+int OutputConsole::rowOfLine(int line) const
+{
+    if (_filter.isEmpty())
+        return line;
+    return std::lower_bound(_rows.begin(), _rows.end(), static_cast<quint32>(line))-_rows.begin();
+}
+
+int OutputConsole::lineOfOffset(int offset) const
+{
+    return std::upper_bound(_lineStart.begin(), _lineStart.end(), static_cast<quint32>(offset))-_lineStart.begin()-1;
+}
+
+int OutputConsole::firstLinkOf(int line) const
+{
+    int lo = 0;
+    int hi = _links.size();
+    while (lo < hi) {
+        int mid = (lo+hi)/2;
+        if (_links[mid].line < line)
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+bool OutputConsole::lineMatches(int line, const QByteArray& needle, bool ci) const
+{
+    int start = _lineStart[line];
+    int end = lineEnd(line);
+    return end-start >= needle.size() &&
+           findForward(_data, start, end-needle.size(), needle, ci) != -1;
+}
+
+void OutputConsole::newLine(void)
+{
+    _data.append('\n');
+    _lineStart.append(_data.size());
+    _lineStyle.append(Plain);
+    _openCols = 0;
+}
+
+void OutputConsole::appendText(const QString& s, Style style)
+{
+    if (s.isEmpty())
+        return;
+    bool follow = verticalScrollBar()->value()==verticalScrollBar()->maximum();
+    if (_lineStart.isEmpty()) {
+        _lineStart.append(0);
+        _lineStyle.append(Plain);
+    }
+    int firstLine = _lineStart.size()-1;
+    QString cur;
+    for (int i=0; i<=s.size(); i++) {
+        if (i==s.size() || s[i]=='\n') {
+            if (!cur.isEmpty()) {
+                int l = _lineStart.size()-1;
+                if (static_cast<int>(_lineStart[l])==_data.size())
+                    _lineStyle[l] = style;
+                _data.append(cur.toUtf8());
+                _openCols += cur.size();
+                _maxLineBytes = std::max(_maxLineBytes, _data.size()-static_cast<int>(_lineStart[l]));
+                cur.clear();
+            }
+            if (i < s.size())
+                newLine();
+        } else if (s[i]=='\t') {
+            int col = _openCols+cur.size();
+            cur.append(QString(tabWidth-col%tabWidth, ' '));
+        } else if (s[i] != '\r') {
+            cur.append(s[i]);
+        }
+    }
+    appended(firstLine, follow);
+}
+
+void OutputConsole::appendMessage(const QString& s, Style style)
+{
+    if (!_lineStart.isEmpty() && lineEnd(_lineStart.size()-1) > static_cast<int>(_lineStart.last()))
+        newLine();
+    appendText(s+"\n", style);
+}
+
+void OutputConsole::appendLink(const QString& text, const QUrl& url, const QString& rest, Style style)
+{
+    if (_lineStart.isEmpty()) {
+        _lineStart.append(0);
+        _lineStyle.append(Plain);
+    } else if (lineEnd(_lineStart.size()-1) > static_cast<int>(_lineStart.last())) {
+        newLine();
+    }
+    Link link;
+    link.line = _lineStart.size()-1;
+    link.col = 0;
+    link.len = text.size();
+    link.style = style;
+    link.url = url.toString();
+    _links.append(link);
+    appendText(text+rest+"\n", Plain);
+}
+
+void OutputConsole::appended(int firstLine, bool follow)
+{
+    if (!_filter.isEmpty()) {
+        // Lines only ever grow, so a line that matched once keeps matching
+        bool ci;
+        QByteArray needle = searchBytes(_filter, Qt::CaseInsensitive, ci);
+        for (int l=firstLine; l<_lineStart.size(); l++) {
+            if ((_rows.isEmpty() || static_cast<int>(_rows.last()) < l) && lineMatches(l, needle, ci))
+                _rows.append(l);
+        }
+    }
+    if (_data.size() > maxBytes)
+        discardHead(lineOfOffset(_data.size()/2));
+    updateScrollBars();
+    if (follow)
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    viewport()->update();
+}
+
+void OutputConsole::discardHead(int n)
+{
+    if (n <= 0)
+        return;
+    int bytes = _lineStart[n];
+    _data.remove(0, bytes);
+    _lineStart.remove(0, n);
+    for (int i=0; i<_lineStart.size(); i++)
+        _lineStart[i] -= bytes;
+    _lineStyle.remove(0, n);
+    int nLinks = firstLinkOf(n);
+    _links.remove(0, nLinks);
+    for (int i=0; i<_links.size(); i++)
+        _links[i].line -= n;
+    // A link pressed before the output scrolled away can no longer be clicked
+    _pressedLink = _pressedLink < nLinks ? -1 : _pressedLink-nLinks;
+    int removedRows = n;
+    if (!_filter.isEmpty()) {
+        removedRows = rowOfLine(n);
+        _rows.remove(0, removedRows);
+        for (int i=0; i<_rows.size(); i++)
+            _rows[i] -= n;
+    }
+    _selAnchor = _selCursor = Pos();
+    verticalScrollBar()->setValue(std::max(0, verticalScrollBar()->value()-removedRows));
+}
+
+void OutputConsole::clear(void)
+{
+    QByteArray().swap(_data);
+    QVector<quint32>().swap(_lineStart);
+    QVector<quint8>().swap(_lineStyle);
+    _links.clear();
+    _pressedLink = -1;
+    _rows.clear();
+    _openCols = 0;
+    _maxLineBytes = 0;
+    _selAnchor = _selCursor = Pos();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void OutputConsole::setFilter(const QString& f)
+{
+    if (f==_filter)
+        return;
+    _filter = f;
+    _rows.clear();
+    if (!_filter.isEmpty()) {
+        bool ci;
+        QByteArray needle = searchBytes(_filter, Qt::CaseInsensitive, ci);
+        for (int l=0; l<_lineStart.size(); l++) {
+            if (lineMatches(l, needle, ci))
+                _rows.append(l);
+        }
+    }
+    _selAnchor = _selCursor = Pos();
+    updateScrollBars();
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    viewport()->update();
+}
+
+int OutputConsole::byteOffset(const Pos& p) const
+{
+    int l = lineOfRow(p.row);
+    return _lineStart[l]+line(l).left(p.col).toUtf8().size();
+}
+
+bool OutputConsole::find(const QString& s, bool backward, Qt::CaseSensitivity cs)
+{
+    if (s.isEmpty() || rowCount()==0)
+        return false;
+    bool ci;
+    QByteArray needle = searchBytes(s, cs, ci);
+    int start;
+    if (hasSelection()) {
+        Pos from = backward ? std::min(_selAnchor,_selCursor) : std::max(_selAnchor,_selCursor);
+        start = byteOffset(from);
+    } else {
+        start = backward ? _data.size() : byteOffset(Pos(verticalScrollBar()->value(),0));
+    }
+    // Search from the start position to the end (or beginning) of the
+    // store, then wrap around; matches in filtered out lines are skipped
+    int found = -1;
+    for (int pass=0; pass<2 && found==-1; pass++) {
+        int from = backward ? (pass==0 ? 0 : start) : (pass==0 ? start : 0);
+        int to = backward ? (pass==0 ? start-needle.size() : _data.size()) : (pass==0 ? _data.size() : start-1);
+        for (;;) {
+            int off = backward ? findBackward(_data, from, to, needle, ci)
+                               : findForward(_data, from, to, needle, ci);
+            if (off == -1)
+                break;
+            int l = lineOfOffset(off);
+            if (_filter.isEmpty() || lineOfRow(std::min(rowOfLine(l), rowCount()-1))==l) {
+                found = off;
+                break;
+            }
+            if (backward)
+                to = static_cast<int>(_lineStart[l])-1;
+            else
+                from = lineEnd(l)+1;
+        }
+    }
+    if (found == -1)
+        return false;
+    int l = lineOfOffset(found);
+    int col = QString::fromUtf8(_data.constData()+_lineStart[l], found-_lineStart[l]).size();
+    int len = QString::fromUtf8(_data.constData()+found, needle.size()).size();
+    int row = rowOfLine(l);
+    _selAnchor = Pos(row, col);
+    _selCursor = Pos(row, col+len);
+    ensureVisible(_selAnchor);
+    ensureVisible(_selCursor);
+    viewport()->update();
+    return true;
+}
+
+QString OutputConsole::selectedText(void) const
+{
+    if (!hasSelection())
+        return QString();
+    Pos selStart = std::min(_selAnchor,_selCursor);
+    Pos selEnd = std::max(_selAnchor,_selCursor);
+    QString ret;
+    for (int r=selStart.row; r<=selEnd.row; r++) {
+        QString text = line(lineOfRow(r));
+        int from = r==selStart.row ? selStart.col : 0;
+        int to = r==selEnd.row ? selEnd.col : text.size();
+        ret += text.mid(from, to-from);
+        if (r != selEnd.row)
+            ret += "\n";
+    }
+    return ret;
+}
+
+void OutputConsole::copy(void)
+{
+    if (hasSelection())
+        QApplication::clipboard()->setText(selectedText());
+}
+
+void OutputConsole::selectAll(void)
+{
+    if (rowCount()==0)
+        return;
+    _selAnchor = Pos(0,0);
+    _selCursor = Pos(rowCount()-1, line(lineOfRow(rowCount()-1)).size());
+    viewport()->update();
+}
+
+int OutputConsole::lineHeight(void) const
+{
+    return fontMetrics().lineSpacing();
+}
+
+int OutputConsole::pageRows(void) const
+{
+    return std::max(1, viewport()->height()/lineHeight());
+}
+
+void OutputConsole::updateScrollBars(void)
+{
+    int rows = pageRows();
+    verticalScrollBar()->setPageStep(rows);
+    verticalScrollBar()->setRange(0, std::max(0, rowCount()-rows));
+    // Estimate the width from the longest line, measuring every line would
+    // defeat the purpose of only laying out visible rows
+    int cw = fontMetrics().averageCharWidth();
+    qint64 width = static_cast<qint64>(_maxLineBytes)*cw+2*margin;
+    width = std::min(width, static_cast<qint64>(1 << 30));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(cw);
+    horizontalScrollBar()->setRange(0, std::max(0, static_cast<int>(width)-viewport()->width()));
+}
+
+QColor OutputConsole::styleColor(int style) const
+{
+    bool dark = palette().color(QPalette::Base).lightness() < 128;
+    switch (style) {
+    case Info:
+        return dark ? QColor(110,160,255) : QColor(Qt::blue);
+    case Error:
+        return dark ? QColor(255,100,100) : QColor(Qt::red);
+    case Warning:
+        return QColor(255,165,0);
+    default:
+        return palette().color(QPalette::Text);
+    }
+}
+
+void OutputConsole::paintEvent(QPaintEvent *e)
+{
+    QPainter painter(viewport());
+    painter.fillRect(e->rect(), palette().base());
+    QFontMetrics fm(font());
+    QFont linkFont = font();
+    linkFont.setUnderline(true);
+    int lh = lineHeight();
+    int x0 = margin-horizontalScrollBar()->value();
+    Pos selStart = std::min(_selAnchor,_selCursor);
+    Pos selEnd = std::max(_selAnchor,_selCursor);
+    int rows = rowCount();
+    int y = 0;
+    for (int r=verticalScrollBar()->value(); r<rows && y<viewport()->height(); r++, y+=lh) {
+        int l = lineOfRow(r);
+        QString text = line(l);
+        if (hasSelection() && selStart.row <= r && r <= selEnd.row) {
+            int from = r==selStart.row ? selStart.col : 0;
+            int to = r==selEnd.row ? selEnd.col : text.size();
+            int xs = x0+fm.width(text.left(from));
+            int xe = x0+fm.width(text.left(to));
+            if (r != selEnd.row)
+                xe += fm.averageCharWidth();
+            painter.fillRect(QRect(xs, y, xe-xs, lh), palette().highlight());
+        }
+        // Draw the line in segments of plain text and (underlined) links
+        int baseline = y+fm.ascent();
+        int x = x0;
+        int col = 0;
+        for (int k=firstLinkOf(l);; k++) {
+            bool isLink = k < _links.size() && _links[k].line==l;
+            int segEnd = isLink ? std::min(_links[k].col, text.size()) : text.size();
+            if (segEnd > col) {
+                QString seg = text.mid(col, segEnd-col);
+                painter.setFont(font());
+                painter.setPen(styleColor(_lineStyle[l]));
+                painter.drawText(x, baseline, seg);
+                x += fm.width(seg);
+                col = segEnd;
+            }
+            if (!isLink)
+                break;
+            int linkEnd = std::min(_links[k].col+_links[k].len, text.size());
+            if (linkEnd > col) {
+                QString seg = text.mid(col, linkEnd-col);
+                painter.setFont(linkFont);
+                painter.setPen(styleColor(_links[k].style));
+                painter.drawText(x, baseline, seg);
+                x += fm.width(seg);
+                col = linkEnd;
+            }
+        }
+    }
+}
+
+void OutputConsole::resizeEvent(QResizeEvent *e)
+{
+    bool follow = verticalScrollBar()->value()==verticalScrollBar()->maximum();
+    QAbstractScrollArea::resizeEvent(e);
+    updateScrollBars();
+    if (follow)
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+void OutputConsole::scrollContentsBy(int, int)
+{
+    viewport()->update();
+}
+
+void OutputConsole::changeEvent(QEvent *e)
+{
+    if (e->type()==QEvent::FontChange) {
+        updateScrollBars();
+        viewport()->update();
+    } else if (e->type()==QEvent::PaletteChange) {
+        viewport()->update();
+    }
+    QAbstractScrollArea::changeEvent(e);
+}
+
+void OutputConsole::keyPressEvent(QKeyEvent *e)
+{
+    if (e==QKeySequence::Copy) {
+        copy();
+    } else if (e==QKeySequence::SelectAll) {
+        selectAll();
+    } else if (e==QKeySequence::MoveToStartOfDocument) {
+        verticalScrollBar()->setValue(0);
+    } else if (e==QKeySequence::MoveToEndOfDocument) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    } else {
+        QAbstractScrollArea::keyPressEvent(e);
+    }
+}
+
+OutputConsole::Pos OutputConsole::posAt(const QPoint& p) const
+{
+    if (rowCount()==0)
+        return Pos();
+    int row = verticalScrollBar()->value()+std::max(0, p.y())/lineHeight();
+    if (p.y() < 0)
+        row--;
+    row = std::max(0, std::min(row, rowCount()-1));
+    QString text = line(lineOfRow(row));
+    QFontMetrics fm(font());
+    int x = p.x()-margin+horizontalScrollBar()->value();
+    int w = 0;
+    for (int c=0; c<text.size(); c++) {
+        int cw = fm.width(text[c]);
+        if (x < w+cw/2)
+            return Pos(row, c);
+        w += cw;
+    }
+    return Pos(row, text.size());
+}
+
+int OutputConsole::linkAt(const Pos& p) const
+{
+    if (rowCount()==0)
+        return -1;
+    int l = lineOfRow(p.row);
+    for (int k=firstLinkOf(l); k<_links.size() && _links[k].line==l; k++) {
+        if (p.col >= _links[k].col && p.col < _links[k].col+_links[k].len)
+            return k;
+    }
+    return -1;
+}
+
+void OutputConsole::ensureVisible(const Pos& p)
+{
+    int first = verticalScrollBar()->value();
+    if (p.row < first || p.row >= first+pageRows())
+        verticalScrollBar()->setValue(p.row-pageRows()/2);
+    int x = fontMetrics().width(line(lineOfRow(p.row)).left(p.col));
+    int h = horizontalScrollBar()->value();
+    if (x < h || x > h+viewport()->width()-2*margin)
+        horizontalScrollBar()->setValue(x-viewport()->width()/2);
+}
+
+void OutputConsole::mousePressEvent(QMouseEvent *e)
+{
+    if (e->button()==Qt::LeftButton) {
+        Pos p = posAt(e->pos());
+        _pressedLink = linkAt(p);
+        if (e->modifiers() & Qt::ShiftModifier) {
+            _selCursor = p;
+        } else {
+            _selAnchor = _selCursor = p;
+        }
+        _selecting = true;
+        viewport()->update();
+    }
+    QAbstractScrollArea::mousePressEvent(e);
+}
+
+void OutputConsole::mouseMoveEvent(QMouseEvent *e)
+{
+    Pos p = posAt(e->pos());
+    if (_selecting && (e->buttons() & Qt::LeftButton)) {
+        if (e->pos().y() < 0)
+            verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        else if (e->pos().y() > viewport()->height())
+            verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        _selCursor = p;
+        viewport()->update();
+    }
+    viewport()->setCursor(linkAt(p) != -1 ? Qt::PointingHandCursor : Qt::IBeamCursor);
+}
+
+void OutputConsole::mouseReleaseEvent(QMouseEvent *e)
+{
+    if (e->button()==Qt::LeftButton) {
+        _selecting = false;
+        if (_pressedLink != -1 && !hasSelection() && linkAt(posAt(e->pos()))==_pressedLink) {
+            emit anchorClicked(QUrl(_links[_pressedLink].url));
+        }
+        _pressedLink = -1;
+    }
+    QAbstractScrollArea::mouseReleaseEvent(e);
+}
+
+void OutputConsole::contextMenuEvent(QContextMenuEvent *e)
+{
+    QMenu menu(this);
+    QAction* copyAction = menu.addAction("Copy", this, SLOT(copy()), QKeySequence::Copy);
+    copyAction->setEnabled(hasSelection());
+    menu.addAction("Select All", this, SLOT(selectAll()), QKeySequence::SelectAll);
+    menu.exec(e->globalPos());
+}
@@ -0,0 +1,113 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef OUTPUTCONSOLE_H
+#define OUTPUTCONSOLE_H
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+#include <QVector>
+#include <QUrl>
+
+/// Read-only console for compiler and solver output.
+///
+/// The text is kept in a compact append-only store (UTF-8 bytes plus one
+/// offset and one style byte per line, links are stored separately), and
+/// only the visible rows are laid out and painted. This keeps memory close
+/// to the size of the output and scrolling independent of its length.
+class OutputConsole : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    enum Style { Plain=0, Info, Error, Warning };
+
+    explicit OutputConsole(QWidget *parent = 0);
+
+    /// Append raw output, which may contain partial lines
+    void appendText(const QString& s, Style style=Plain);
+    /// Append \a s as a message on a line of its own
+    void appendMessage(const QString& s, Style style=Info);
+    /// Append a line consisting of a clickable \a text linking to \a url, followed by \a rest
+    void appendLink(const QString& text, const QUrl& url, const QString& rest=QString(), Style style=Error);
+
+    int lineCount(void) const { return _lineStart.size(); }
+    QString line(int i) const;
+
+    /// Only show lines containing \a f (case insensitive), or all lines if \a f is empty
+    void setFilter(const QString& f);
+    /// Find the next occurrence of \a s (wrapping around), select it and scroll to it
+    bool find(const QString& s, bool backward=false, Qt::CaseSensitivity cs=Qt::CaseInsensitive);
+
+    bool hasSelection(void) const { return _selAnchor != _selCursor; }
+    QString selectedText(void) const;
+public slots:
+    void clear(void);
+    void copy(void);
+    void selectAll(void);
+signals:
+    void anchorClicked(const QUrl& url);
+protected:
+    void paintEvent(QPaintEvent *);
+    void resizeEvent(QResizeEvent *);
+    void scrollContentsBy(int dx, int dy);
+    void changeEvent(QEvent *);
+    void keyPressEvent(QKeyEvent *);
+    void mousePressEvent(QMouseEvent *);
+    void mouseMoveEvent(QMouseEvent *);
+    void mouseReleaseEvent(QMouseEvent *);
+    void contextMenuEvent(QContextMenuEvent *);
+private:
+    struct Link {
+        int line;
+        int col;
+        int len;
+        int style;
+        QString url;
+    };
+    /// A position in row (not line) coordinates, so that it follows the filter
+    struct Pos {
+        int row;
+        int col;
+        Pos(int r=0, int c=0) : row(r), col(c) {}
+        bool operator ==(const Pos& p) const { return row==p.row && col==p.col; }
+        bool operator !=(const Pos& p) const { return !(*this==p); }
+        bool operator <(const Pos& p) const { return row < p.row || (row==p.row && col < p.col); }
+    };
+
+    QByteArray _data;
+    QVector<quint32> _lineStart;
+    QVector<quint8> _lineStyle;
+    QVector<Link> _links;
+    int _openCols;
+    int _maxLineBytes;
+
+    QString _filter;
+    QVector<quint32> _rows;
+
+    Pos _selAnchor;
+    Pos _selCursor;
+    bool _selecting;
+    int _pressedLink;
+
+    int lineEnd(int i) const;
+    int rowCount(void) const;
+    int lineOfRow(int row) const;
+    int rowOfLine(int line) const;
+    int lineOfOffset(int offset) const;
+    int firstLinkOf(int line) const;
+    bool lineMatches(int line, const QByteArray& needle, bool ci) const;
+    void newLine(void);
+    void appended(int firstLine, bool follow);
+    void discardHead(int n);
+    void updateScrollBars(void);
+    int lineHeight(void) const;
+    int pageRows(void) const;
+    Pos posAt(const QPoint& p) const;
+    int linkAt(const Pos& p) const;
+    int byteOffset(const Pos& p) const;
+    void ensureVisible(const Pos& p);
+    QColor styleColor(int style) const;
+};
+
+#endif // OUTPUTCONSOLE_H
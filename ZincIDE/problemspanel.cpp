@@ -0,0 +1,189 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "problemspanel.h"
+
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QSortFilterProxyModel>
+
+namespace {
+    const char* severityNames[] = { "Error", "Warning", "Note" };
+}
+
+ProblemsModel::ProblemsModel(QObject *parent) :
+    QAbstractTableModel(parent)
+{
+}
+
+int ProblemsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : _diagnostics.size();
+}
+
+int ProblemsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : NumColumns;
+}
+
+QVariant ProblemsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= _diagnostics.size())
+        return QVariant();
+    const DiagnosticParser::Diagnostic& d = _diagnostics[index.row()];
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case SeverityColumn: return QString(severityNames[d.severity]);
+        case FileColumn: return QFileInfo(d.file).fileName();
+        case LineColumn: return d.line;
+        case ColumnColumn: return d.col > 0 ? QVariant(d.col) : QVariant();
+        case MessageColumn: return d.message;
+        }
+    } else if (role == Qt::UserRole) {
+        // Sort key: severities by rank, files by full path
+        switch (index.column()) {
+        case SeverityColumn: return int(d.severity);
+        case FileColumn: return d.file;
+        case LineColumn: return d.line;
+        case ColumnColumn: return d.col;
+        case MessageColumn: return d.message;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        return index.column()==FileColumn ? d.file : d.message;
+    }
+    return QVariant();
+}
+
+QVariant ProblemsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+    switch (section) {
+    case SeverityColumn: return QString("Severity");
+    case FileColumn: return QString("File");
+    case LineColumn: return QString("Line");
+    case ColumnColumn: return QString("Column");
+    case MessageColumn: return QString("Message");
+    }
+    return QVariant();
+}
+
+void ProblemsModel::append(const QVector<DiagnosticParser::Diagnostic>& d)
+{
+    if (d.isEmpty())
+        return;
+    beginInsertRows(QModelIndex(), _diagnostics.size(), _diagnostics.size()+d.size()-1);
+    _diagnostics += d;
+    endInsertRows();
+}
+
+void ProblemsModel::appendToLastMessage(const QString& text)
+{
+    if (_diagnostics.isEmpty())
+        return;
+    QString& m = _diagnostics.last().message;
+    if (m.isEmpty()) {
+        m = text;
+        _diagnostics.last().severity = DiagnosticParser::severity(text);
+    } else {
+        m += " "+text;
+    }
+    int row = _diagnostics.size()-1;
+    emit dataChanged(index(row, 0), index(row, NumColumns-1));
+}
+
+void ProblemsModel::clear(void)
+{
+    beginResetModel();
+    _diagnostics.clear();
+    endResetModel();
+}
+
+ProblemsPanel::ProblemsPanel(QWidget *parent) :
+    QTreeView(parent)
+{
+    _model = new ProblemsModel(this);
+    _proxy = new QSortFilterProxyModel(this);
+    _proxy->setSourceModel(_model);
+    _proxy->setSortRole(Qt::UserRole);
+    setModel(_proxy);
+    setRootIsDecorated(false);
+    setUniformRowHeights(true);
+    setAlternatingRowColors(true);
+    setSortingEnabled(true);
+    sortByColumn(ProblemsModel::SeverityColumn, Qt::AscendingOrder);
+    header()->setStretchLastSection(true);
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(100);
+    connect(&_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    connect(this, SIGNAL(activated(QModelIndex)), this, SLOT(rowActivated(QModelIndex)));
+}
+
+void ProblemsPanel::add(const DiagnosticParser::Diagnostic& d)
+{
+    _pending.append(d);
+    if (!_flushTimer.isActive())
+        _flushTimer.start();
+}
+
+void ProblemsPanel::appendToLastMessage(const QString& text)
+{
+    if (_pending.isEmpty()) {
+        _model->appendToLastMessage(text);
+        if (_model->diagnostics().isEmpty())
+            return;
+        const DiagnosticParser::Diagnostic& last = _model->diagnostics().last();
+        QHash<QString,QVector<DiagnosticParser::Diagnostic> >::iterator f = _byFile.find(last.file);
+        if (f != _byFile.end() && !f.value().isEmpty()) {
+            f.value().last() = last;
+            _touched.insert(last.file);
+            if (!_flushTimer.isActive())
+                _flushTimer.start();
+        }
+        return;
+    }
+    DiagnosticParser::Diagnostic& d = _pending.last();
+    if (d.message.isEmpty()) {
+        d.message = text;
+        d.severity = DiagnosticParser::severity(text);
+    } else {
+        d.message += " "+text;
+    }
+}
+
+void ProblemsPanel::flush(void)
+{
+    _flushTimer.stop();
+    if (_pending.isEmpty() && _touched.isEmpty())
+        return;
+    for (int i=0; i<_pending.size(); i++) {
+        _byFile[_pending[i].file].append(_pending[i]);
+        _touched.insert(_pending[i].file);
+    }
+    _model->append(_pending);
+    _pending.clear();
+    QStringList files = _touched.toList();
+    _touched.clear();
+    emit changed(files);
+}
+
+void ProblemsPanel::clear(void)
+{
+    _flushTimer.stop();
+    _pending.clear();
+    _touched.clear();
+    _model->clear();
+    QStringList files = _byFile.keys();
+    _byFile.clear();
+    emit changed(files);
+}
+
+void ProblemsPanel::rowActivated(const QModelIndex& index)
+{
+    QModelIndex source = _proxy->mapToSource(index);
+    if (!source.isValid())
+        return;
+    const DiagnosticParser::Diagnostic& d = _model->diagnostics()[source.row()];
+    emit problemActivated(d.file, d.line, d.col);
+}
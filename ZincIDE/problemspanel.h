@@ -0,0 +1,82 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PROBLEMSPANEL_H
+#define PROBLEMSPANEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTreeView>
+#include <QTimer>
+#include <QVector>
+
+#include "diagnosticparser.h"
+
+class QSortFilterProxyModel;
+
+/// Table of the diagnostics reported by the compiler and the solvers
+class ProblemsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column { SeverityColumn=0, FileColumn, LineColumn, ColumnColumn, MessageColumn, NumColumns };
+
+    explicit ProblemsModel(QObject *parent = 0);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+
+    /// Append \a d as one batch of rows
+    void append(const QVector<DiagnosticParser::Diagnostic>& d);
+    /// Add \a text to the message of the last diagnostic
+    void appendToLastMessage(const QString& text);
+    const QVector<DiagnosticParser::Diagnostic>& diagnostics(void) const { return _diagnostics; }
+    void clear(void);
+private:
+    QVector<DiagnosticParser::Diagnostic> _diagnostics;
+};
+
+/// Sortable view of the diagnostics of the last compilation or run.
+///
+/// Diagnostics can arrive much faster than a view can show them one by
+/// one, so they are queued and inserted into the model in batches. The
+/// diagnostics are also indexed by file, and each batch reports the files
+/// it touched, so that only the editors of those files need updating.
+class ProblemsPanel : public QTreeView
+{
+    Q_OBJECT
+public:
+    explicit ProblemsPanel(QWidget *parent = 0);
+    /// Queue \a d for the next batch
+    void add(const DiagnosticParser::Diagnostic& d);
+    /// Add \a text, a continuation line, to the message of the last diagnostic
+    void appendToLastMessage(const QString& text);
+    /// All diagnostics reported for \a file
+    QVector<DiagnosticParser::Diagnostic> diagnosticsFor(const QString& file) const { return _byFile.value(file); }
+    int count(void) const { return _model->rowCount()+_pending.size(); }
+public slots:
+    void clear(void);
+    /// Insert the queued diagnostics into the model
+    void flush(void);
+signals:
+    /// Emitted after a batch of diagnostics has been added, or the panel
+    /// cleared, with the files whose diagnostics have changed
+    void changed(const QStringList& files);
+    void problemActivated(const QString& file, int line, int col);
+private slots:
+    void rowActivated(const QModelIndex& index);
+private:
+    ProblemsModel* _model;
+    QSortFilterProxyModel* _proxy;
+    QVector<DiagnosticParser::Diagnostic> _pending;
+    QHash<QString,QVector<DiagnosticParser::Diagnostic> > _byFile;
+    /// Files whose last diagnostic got a longer message since the last batch
+    QSet<QString> _touched;
+    QTimer _flushTimer;
+};
+
+#endif // PROBLEMSPANEL_H
@@ -0,0 +1,177 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "processmonitor.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QPainter>
+#include <QPaintEvent>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+static const int historySize = 60;
+
+ProcessMonitor::ProcessMonitor(QWidget *parent) :
+    QWidget(parent)
+{
+    reset();
+}
+
+void ProcessMonitor::reset(void)
+{
+    nSamples = 0;
+    lastTicks = 0;
+    cpu = 0;
+    threads = 0;
+    rss = 0;
+    _peakRss = 0;
+    _peakCpu = 0;
+    _peakThreads = 0;
+    history.clear();
+    hide();
+}
+
+#ifdef Q_OS_LINUX
+namespace {
+    struct ProcStat {
+        qint64 ppid;
+        qint64 ticks;
+        int threads;
+        qint64 rssPages;
+    };
+
+    bool readProcStat(const QString& pid, ProcStat& ps)
+    {
+        QFile f("/proc/"+pid+"/stat");
+        if (!f.open(QFile::ReadOnly))
+            return false;
+        QByteArray stat = f.readAll();
+        // The command name is enclosed in parentheses and may itself contain
+        // spaces and parentheses, so start parsing after the last ')'
+        int commEnd = stat.lastIndexOf(')');
+        if (commEnd == -1)
+            return false;
+        QList<QByteArray> fields = stat.mid(commEnd+2).split(' ');
+        if (fields.size() < 22)
+            return false;
+        ps.ppid = fields[1].toLongLong();
+        ps.ticks = fields[11].toLongLong()+fields[12].toLongLong();
+        ps.threads = fields[17].toInt();
+        ps.rssPages = fields[21].toLongLong();
+        return true;
+    }
+}
+#endif
+
+void ProcessMonitor::sample(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    if (pid <= 0)
+        return;
+    QHash<qint64,ProcStat> procs;
+    QMultiHash<qint64,qint64> children;
+    QStringList entries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (int i=0; i<entries.size(); i++) {
+        bool isPid;
+        qint64 p = entries[i].toLongLong(&isPid);
+        ProcStat ps;
+        if (isPid && readProcStat(entries[i], ps)) {
+            procs.insert(p, ps);
+            children.insert(ps.ppid, p);
+        }
+    }
+    if (!procs.contains(pid))
+        return;
+
+    qint64 ticks = 0;
+    int nThreads = 0;
+    qint64 rssPages = 0;
+    QVector<qint64> todo;
+    todo.append(pid);
+    while (!todo.isEmpty()) {
+        qint64 p = todo.back();
+        todo.pop_back();
+        const ProcStat& ps = procs[p];
+        ticks += ps.ticks;
+        nThreads += ps.threads;
+        rssPages += ps.rssPages;
+        QMultiHash<qint64,qint64>::const_iterator it = children.constFind(p);
+        for (; it != children.constEnd() && it.key()==p; ++it)
+            todo.append(it.value());
+    }
+
+    static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    qint64 elapsed = wallClock.restart();
+    if (nSamples > 0 && elapsed > 0) {
+        cpu = static_cast<int>((ticks-lastTicks)*100000/(ticksPerSecond*elapsed));
+    }
+    lastTicks = ticks;
+    threads = nThreads;
+    rss = rssPages*pageSize;
+    _peakRss = std::max(_peakRss, rss);
+    _peakCpu = std::max(_peakCpu, cpu);
+    _peakThreads = std::max(_peakThreads, threads);
+    history.append(rss);
+    if (history.size() > historySize)
+        history.pop_front();
+    nSamples++;
+    if (isHidden()) {
+        show();
+        updateGeometry();
+    }
+    update();
+#else
+    Q_UNUSED(pid);
+#endif
+}
+
+QString ProcessMonitor::formatBytes(qint64 bytes)
+{
+    if (bytes >= 1024*1024*1024)
+        return QString().number(bytes/(1024.0*1024.0*1024.0),'f',1)+" GB";
+    if (bytes >= 1024*1024)
+        return QString().number(bytes/(1024*1024))+" MB";
+    return QString().number(bytes/1024)+" KB";
+}
+
+QString ProcessMonitor::text(void) const
+{
+    return "CPU "+QString().number(cpu)+"%, "+QString().number(threads)+
+           (threads==1 ? " thread, " : " threads, ")+
+           formatBytes(rss)+" (peak "+formatBytes(_peakRss)+")";
+}
+
+QSize ProcessMonitor::sizeHint() const
+{
+    return QSize(fontMetrics().width("CPU 0000%, 000 threads, 000.0 GB (peak 000.0 GB)")+historySize+8,
+                 fontMetrics().height());
+}
+
+void ProcessMonitor::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    int sparkWidth = historySize;
+    QRect sparkRect(0, 2, sparkWidth, height()-4);
+    painter.fillRect(sparkRect, palette().base());
+    if (history.size() > 1 && _peakRss > 0) {
+        QPolygonF line;
+        for (int i=0; i<history.size(); i++) {
+            qreal x = sparkRect.left()+i;
+            qreal y = sparkRect.bottom()-(sparkRect.height()-1)*static_cast<qreal>(history[i])/_peakRss;
+            line.append(QPointF(x,y));
+        }
+        painter.setPen(Qt::darkGreen);
+        painter.drawPolyline(line);
+    }
+    painter.setPen(palette().color(QPalette::WindowText));
+    painter.drawText(QRect(sparkWidth+6, 0, width()-sparkWidth-6, height()),
+                     Qt::AlignLeft | Qt::AlignVCenter, text());
+}
@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PROCESSMONITOR_H
+#define PROCESSMONITOR_H
+
+#include <QWidget>
+#include <QVector>
+#include <QElapsedTimer>
+
+/// Samples CPU and memory usage of a process and all of its descendants
+/// (read from /proc, so only available on Linux), and displays the
+/// current values together with a small memory sparkline.
+class ProcessMonitor : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ProcessMonitor(QWidget *parent = 0);
+    /// Forget all samples and peak values (called when a new process is started)
+    void reset(void);
+    /// Take a sample of the process tree rooted at \a pid
+    void sample(qint64 pid);
+    bool hasSamples(void) const { return nSamples > 0; }
+    qint64 peakRss(void) const { return _peakRss; }
+    int peakCpu(void) const { return _peakCpu; }
+    int peakThreads(void) const { return _peakThreads; }
+    static QString formatBytes(qint64 bytes);
+    QSize sizeHint() const;
+protected:
+    void paintEvent(QPaintEvent *);
+private:
+    int nSamples;
+    qint64 lastTicks;
+    QElapsedTimer wallClock;
+    int cpu;
+    int threads;
+    qint64 rss;
+    qint64 _peakRss;
+    int _peakCpu;
+    int _peakThreads;
+    QVector<qint64> history;
+    QString text(void) const;
+};
+
+#endif // PROCESSMONITOR_H
@@ -337,6 +337,8 @@ void Project::setModified(bool flag, bool files)
                 haveSolverFlags(haveSolverFlags(),true);
                 solverFlags(solverFlags(),true);
                 solverVerbose(solverVerbose(),true);
+                timeLimit(timeLimit(),true);
+                memoryLimit(memoryLimit(),true);
             }
         }
     }
@@ -394,6 +396,15 @@ bool Project::solverVerbose(void) const
     return ui->conf_solver_verbose->isChecked();
 }
 
+int Project::timeLimit(void) const
+{
+    return ui->conf_timeLimit->value();
+}
+int Project::memoryLimit(void) const
+{
+    return ui->conf_memLimit->value();
+}
+
 bool Project::isUndefined() const
 {
     return projectRoot.isEmpty();
@@ -499,6 +510,26 @@ void Project::solverVerbose(bool b, bool init)
     }
 }
 
+void Project::timeLimit(int t, bool init)
+{
+    if (init) {
+        _timeLimit = t;
+        ui->conf_timeLimit->setValue(t);
+    } else {
+        checkModified();
+    }
+}
+
+void Project::memoryLimit(int m, bool init)
+{
+    if (init) {
+        _memoryLimit = m;
+        ui->conf_memLimit->setValue(m);
+    } else {
+        checkModified();
+    }
+}
+
 int Project::currentDataFileIndex(void) const
 {
     return ui->conf_data_file->currentIndex();
@@ -563,6 +594,14 @@ void Project::checkModified()
         setModified(true);
         return;
     }
+    if (timeLimit() != _timeLimit) {
+        setModified(true);
+        return;
+    }
+    if (memoryLimit() != _memoryLimit) {
+        setModified(true);
+        return;
+    }
     setModified(false);
 }
 
@@ -77,6 +77,8 @@ public:
     bool haveSolverFlags(void) const;
     QString solverFlags(void) const;
     bool solverVerbose(void) const;
+    int timeLimit(void) const;
+    int memoryLimit(void) const;
     CourseraProject& coursera(void) { return *_courseraProject; }
     bool isUndefined(void) const;
 public slots:
@@ -90,6 +92,8 @@ public slots:
     void haveSolverFlags(bool b, bool init=false);
     void solverFlags(const QString& s, bool init=false);
     void solverVerbose(bool b, bool init=false);
+    void timeLimit(int t, bool init=false);
+    void memoryLimit(int m, bool init=false);
 signals:
     void fileRenamed(const QString& oldName, const QString& newName);
     void modificationChanged(bool);
@@ -116,6 +120,8 @@ protected:
     bool _haveSolverFlags;
     QString _solverFlags;
     bool _solverVerbose;
+    int _timeLimit;
+    int _memoryLimit;
     CourseraProject* _courseraProject;
 
     void checkModified(void);
@@ -0,0 +1,196 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "rtfexporter.h"
+#include "tokenizer.h"
+
+#include <QMimeData>
+#include <QTextBlock>
+#include <QTextLayout>
+
+#include <algorithm>
+
+namespace {
+    bool rangeBefore(const QTextLayout::FormatRange& r0, const QTextLayout::FormatRange& r1)
+    {
+        return r0.start < r1.start;
+    }
+
+    void appendHtmlEscaped(QByteArray& out, const QString& s, int from, int to)
+    {
+        QString escaped;
+        escaped.reserve(to-from);
+        for (int i=from; i<to; i++) {
+            switch (s[i].unicode()) {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '"': escaped += "&quot;"; break;
+            default: escaped += s[i];
+            }
+        }
+        out += escaped.toUtf8();
+    }
+
+    void appendRtfEscaped(QByteArray& out, const QString& s, int from, int to)
+    {
+        for (int i=from; i<to; i++) {
+            ushort c = s[i].unicode();
+            if (c=='\\' || c=='{' || c=='}') {
+                out += '\\';
+                out += static_cast<char>(c);
+            } else if (c=='\t') {
+                out += "\\tab ";
+            } else if (c < 0x80) {
+                out += static_cast<char>(c);
+            } else {
+                // RTF encodes Unicode characters as signed 16 bit numbers,
+                // followed by a replacement for readers without Unicode support
+                out += "\\u"+QByteArray::number(static_cast<short>(c))+"?";
+            }
+        }
+    }
+}
+
+RtfExporter::RtfExporter(const QFont& font)
+    : _font(font)
+{
+}
+
+void RtfExporter::appendRun(const QString& text, int from, int to, const QTextCharFormat& format)
+{
+    if (from >= to)
+        return;
+    bool coloured = format.hasProperty(QTextFormat::ForegroundBrush);
+    bool bold = format.fontWeight() > QFont::Normal;
+    bool italic = format.fontItalic();
+    if (!coloured && !bold && !italic) {
+        appendHtmlEscaped(_html, text, from, to);
+        appendRtfEscaped(_rtf, text, from, to);
+        return;
+    }
+    QByteArray style;
+    _rtf += "{";
+    if (coloured) {
+        QColor c = format.foreground().color();
+        int idx = _colors.value(c.rgb(), 0);
+        if (idx==0) {
+            _colorTable.append(c.rgb());
+            idx = _colorTable.size();
+            _colors.insert(c.rgb(), idx);
+        }
+        style += "color:"+c.name().toLatin1()+";";
+        _rtf += "\\cf"+QByteArray::number(idx);
+    }
+    if (bold) {
+        style += "font-weight:bold;";
+        _rtf += "\\b";
+    }
+    if (italic) {
+        style += "font-style:italic;";
+        _rtf += "\\i";
+    }
+    _rtf += " ";
+    _html += "<span style=\""+style+"\">";
+    appendHtmlEscaped(_html, text, from, to);
+    appendRtfEscaped(_rtf, text, from, to);
+    _html += "</span>";
+    _rtf += "}";
+}
+
+void RtfExporter::exportRange(const QTextDocument* doc, int start, int end)
+{
+    QTextBlock block = doc->findBlock(start);
+    while (block.isValid() && block.position() < end) {
+        QString text = block.text();
+        int from = std::max(start-block.position(), 0);
+        int to = std::min(end-block.position(), text.size());
+        QList<QTextLayout::FormatRange> ranges = block.layout()->additionalFormats();
+        std::sort(ranges.begin(), ranges.end(), rangeBefore);
+        int pos = from;
+        for (int i=0; i<ranges.size(); i++) {
+            int rangeStart = std::max(ranges[i].start, pos);
+            int rangeEnd = std::min(ranges[i].start+ranges[i].length, to);
+            if (rangeEnd <= rangeStart)
+                continue;
+            appendRun(text, pos, rangeStart, QTextCharFormat());
+            appendRun(text, rangeStart, rangeEnd, ranges[i].format);
+            pos = rangeEnd;
+        }
+        appendRun(text, pos, to, QTextCharFormat());
+        _text += text.midRef(from, to-from);
+        block = block.next();
+        if (block.isValid() && block.position() <= end) {
+            _text += "\n";
+            _html += "\n";
+            _rtf += "\\par\n";
+        }
+    }
+}
+
+void RtfExporter::exportText(const QString& text, const QVector<QTextCharFormat>& formats)
+{
+    QVector<Tokenizer::Token> tokens;
+    bool inComment = false;
+    int start = 0;
+    for (;;) {
+        int nl = text.indexOf('\n', start);
+        QString line = text.mid(start, (nl==-1 ? text.size() : nl)-start);
+        tokens.clear();
+        inComment = Tokenizer::tokenize(line, inComment, tokens);
+        int pos = 0;
+        for (int i=0; i<tokens.size(); i++) {
+            appendRun(line, pos, tokens[i].start, formats[Tokenizer::Plain]);
+            appendRun(line, tokens[i].start, tokens[i].start+tokens[i].length, formats[tokens[i].cls]);
+            pos = tokens[i].start+tokens[i].length;
+        }
+        appendRun(line, pos, line.size(), formats[Tokenizer::Plain]);
+        _text += line;
+        if (nl == -1)
+            break;
+        _text += "\n";
+        _html += "\n";
+        _rtf += "\\par\n";
+        start = nl+1;
+    }
+}
+
+QByteArray RtfExporter::html(void) const
+{
+    int pointSize = _font.pointSize() > 0 ? _font.pointSize() : 12;
+    QByteArray family = _font.family().toHtmlEscaped().toUtf8();
+    return "<!DOCTYPE html><html><head><meta charset=\"utf-8\"></head><body>"
+           "<pre style=\"font-family:'"+family+"'; font-size:"+QByteArray::number(pointSize)+"pt;\">"+
+           _html+"</pre></body></html>";
+}
+
+QByteArray RtfExporter::rtf(void) const
+{
+    int pointSize = _font.pointSize() > 0 ? _font.pointSize() : 12;
+    QByteArray family;
+    appendRtfEscaped(family, _font.family(), 0, _font.family().size());
+    QByteArray ret = "{\\rtf1\\ansi\\deff0{\\fonttbl{\\f0\\fmodern "+family+";}}{\\colortbl;";
+    for (int i=0; i<_colorTable.size(); i++) {
+        ret += "\\red"+QByteArray::number(qRed(_colorTable[i]))+
+               "\\green"+QByteArray::number(qGreen(_colorTable[i]))+
+               "\\blue"+QByteArray::number(qBlue(_colorTable[i]))+";";
+    }
+    ret += "}\\f0\\fs"+QByteArray::number(pointSize*2)+" ";
+    ret += _rtf;
+    ret += "}";
+    return ret;
+}
+
+QMimeData* RtfExporter::mimeData(void) const
+{
+    QMimeData* md = new QMimeData;
+    md->setText(_text);
+    md->setHtml(QString::fromUtf8(html()));
+#ifdef Q_OS_WIN
+    md->setData("application/x-qt-windows-mime;value=\"Rich Text Format\"", rtf());
+#else
+    md->setData("text/rtf", rtf());
+#endif
+    return md;
+}
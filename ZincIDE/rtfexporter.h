@@ -1,8 +1,51 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
 #ifndef RTFEXPORTER_H
 #define RTFEXPORTER_H
 
+#include <QByteArray>
+#include <QFont>
+#include <QMap>
+#include <QTextCharFormat>
+#include <QTextDocument>
+
+class QMimeData;
+
+/// Serialises a range of a syntax highlighted document as HTML and RTF.
+///
+/// The blocks of the range and their highlighting format ranges are walked
+/// once, appending directly to the output, so that exporting is linear in
+/// the size of the range.
+class RtfExporter {
+public:
+    explicit RtfExporter(const QFont& font);
+    /// Export the characters from position \a start to \a end of \a doc
+    void exportRange(const QTextDocument* doc, int start, int end);
+    /// Export \a text, highlighted by the Tokenizer using \a formats for the
+    /// token classes. Does not need a QTextDocument, so it is safe to call
+    /// from any thread.
+    void exportText(const QString& text, const QVector<QTextCharFormat>& formats);
+    QByteArray html(void) const;
+    QByteArray rtf(void) const;
+    /// Create clipboard data containing plain text, HTML and RTF
+    QMimeData* mimeData(void) const;
+private:
+    QFont _font;
+    QString _text;
+    QByteArray _html;
+    QByteArray _rtf;
+    QMap<QRgb,int> _colors;
+    QVector<QRgb> _colorTable;
+    void appendRun(const QString& text, int from, int to, const QTextCharFormat& format);
+};
+
+#ifdef Q_OS_MAC
 #include <QMacPasteboardMime>
 
+/// Makes the RTF created by RtfExporter available as public.rtf on the
+/// Mac pasteboard
 class MyRtfMime : QMacPasteboardMime {
 public:
     MyRtfMime() : QMacPasteboardMime(MIME_ALL) { }
@@ -12,18 +55,26 @@ public:
     }
     QString mimeFor(QString flav) {
         if (flav==QString("public.rtf"))
-            return QString("text/html");
+            return QString("text/rtf");
         return QString();
     }
     QString flavorFor(const QString &mime) {
-        if (mime==QString("text/html"))
+        if (mime==QString("text/rtf"))
             return QString("public.rtf");
         return QString();
     }
-    QVariant convertToMime(const QString &mimeType, QList<QByteArray> data, QString flavor);
-
-    QList<QByteArray> convertFromMime(const QString &mime, QVariant data, QString flav);
+    QVariant convertToMime(const QString &mimeType, QList<QByteArray> data, QString flavor) {
+        if (!canConvert(mimeType, flavor) || data.isEmpty())
+            return QVariant();
+        return data.first();
+    }
+    QList<QByteArray> convertFromMime(const QString &mime, QVariant data, QString flavor) {
+        QList<QByteArray> ret;
+        if (canConvert(mime, flavor))
+            ret << data.toByteArray();
+        return ret;
+    }
 };
-
+#endif
 
 #endif // RTFEXPORTER_H
@@ -0,0 +1,71 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "settings.h"
+
+#include <QSettings>
+#include <QStringList>
+
+/// Writes arriving within this time are written to disk together
+static const int writeDelay = 500;
+
+Settings* Settings::instance(void)
+{
+    static Settings settings;
+    return &settings;
+}
+
+Settings::Settings(void)
+{
+    QSettings s;
+    QStringList keys = s.allKeys();
+    for (int i=0; i<keys.size(); i++)
+        _values.insert(keys[i], s.value(keys[i]));
+    readSolvers();
+    _writeTimer.setSingleShot(true);
+    _writeTimer.setInterval(writeDelay);
+    connect(&_writeTimer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+QVariant Settings::value(const QString& key, const QVariant& defaultValue) const
+{
+    return _values.value(key, defaultValue);
+}
+
+void Settings::setValue(const QString& key, const QVariant& value)
+{
+    _values.insert(key, value);
+    _changed.insert(key);
+    if (!_writeTimer.isActive())
+        _writeTimer.start();
+}
+
+void Settings::flush(void)
+{
+    _writeTimer.stop();
+    if (_changed.isEmpty())
+        return;
+    QSettings s;
+    for (QSet<QString>::const_iterator it = _changed.begin(); it != _changed.end(); ++it)
+        s.setValue(*it, _values.value(*it));
+    s.sync();
+    _changed.clear();
+}
+
+void Settings::readSolvers(void)
+{
+    _solvers.clear();
+    int n = value("solvers/size", 0).toInt();
+    for (int i=0; i<n; i++) {
+        QString prefix = "solvers/"+QString().number(i+1)+"/";
+        Solver solver;
+        solver.name = value(prefix+"name").toString();
+        solver.executable = value(prefix+"executable").toString();
+        solver.mznlib = value(prefix+"mznlib").toString();
+        solver.backend = value(prefix+"backend").toString();
+        solver.builtin = value(prefix+"builtin").toBool();
+        solver.detach = value(prefix+"detach", false).toBool();
+        _solvers.append(solver);
+    }
+}
@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QVariant>
+#include <QVector>
+
+#include "solverdialog.h"
+
+/// The settings of the IDE, read from disk once and shared by all windows.
+///
+/// Keys are QSettings paths such as "MainWindow/editorFont". Reads are
+/// served from memory. Writes take effect in memory at once and are
+/// written to disk together shortly afterwards, or when flush() is called.
+class Settings : public QObject
+{
+    Q_OBJECT
+public:
+    static Settings* instance(void);
+
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    void setValue(const QString& key, const QVariant& value);
+
+    /// The solvers saved in the settings, read once at startup
+    const QVector<Solver>& solvers(void) const { return _solvers; }
+public slots:
+    /// Write the pending changes to disk
+    void flush(void);
+private:
+    Settings(void);
+    QHash<QString,QVariant> _values;
+    QSet<QString> _changed;
+    QTimer _writeTimer;
+    QVector<Solver> _solvers;
+    void readSolvers(void);
+};
+
+#endif // SETTINGS_H
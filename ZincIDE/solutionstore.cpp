@@ -0,0 +1,132 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "solutionstore.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+
+static const qint64 minCapacity = 64*1024;
+
+SolutionStore::SolutionStore(int nVis)
+    : _nVis(nVis), _file(QDir::tempPath()+"/mznide-solutions-XXXXXX"),
+      _end(0), _capacity(0), _map(NULL), _mapped(0)
+{
+    _file.open();
+}
+
+SolutionStore::~SolutionStore(void)
+{
+    if (_map)
+        _file.unmap(_map);
+}
+
+bool SolutionStore::append(const QStringList& data)
+{
+    if (!_file.isOpen())
+        return false;
+    QList<QByteArray> bs;
+    qint64 size = 0;
+    for (int i=0; i<_nVis; i++) {
+        bs.append(i < data.size() ? data[i].toUtf8() : QByteArray());
+        size += bs.last().size();
+    }
+    if (_end+size > _capacity) {
+        // A mapped file cannot be resized on all platforms
+        if (_map) {
+            _file.unmap(_map);
+            _map = NULL;
+            _mapped = 0;
+        }
+        qint64 capacity = std::max(std::max(minCapacity, 2*_capacity), _end+size);
+        if (!_file.resize(capacity))
+            return false;
+        _capacity = capacity;
+        _file.seek(_end);
+    }
+    for (int i=0; i<_nVis; i++) {
+        const QByteArray& b = bs[i];
+        _offsets.append(_end);
+        if (_file.write(b) != b.size()) {
+            _offsets.resize(_offsets.size()-i-1);
+            _file.seek(_end);
+            return false;
+        }
+        _end += b.size();
+    }
+    _file.flush();
+    return true;
+}
+
+int SolutionStore::size(void) const
+{
+    return _nVis==0 ? 0 : _offsets.size()/_nVis;
+}
+
+QByteArray SolutionStore::record(int k) const
+{
+    qint64 start = _offsets[k];
+    qint64 end = k+1 < _offsets.size() ? _offsets[k+1] : _end;
+    if (end > _mapped) {
+        // The file has grown since it was last mapped
+        if (_map)
+            _file.unmap(_map);
+        _map = _file.map(0, _capacity);
+        _mapped = _map ? _capacity : 0;
+    }
+    if (_map)
+        return QByteArray(reinterpret_cast<const char*>(_map+start), end-start);
+    // Fall back to reading if the file cannot be mapped
+    _file.seek(start);
+    QByteArray b = _file.read(end-start);
+    _file.seek(_end);
+    return b;
+}
+
+QString SolutionStore::get(int n, int vis) const
+{
+    if (n < 0 || n >= size() || vis < 0 || vis >= _nVis)
+        return QString();
+    return QString::fromUtf8(record(n*_nVis+vis));
+}
+
+bool SolutionStore::exportCSV(const QString& fileName) const
+{
+    QFile f(fileName);
+    if (!f.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+    f.write("solution,visualisation,data\n");
+    for (int n=0; n<size(); n++) {
+        for (int v=0; v<_nVis; v++) {
+            QByteArray data = record(n*_nVis+v);
+            data.replace('"', "\"\"");
+            f.write(QByteArray::number(n)+","+QByteArray::number(v)+",\""+data+"\"\n");
+        }
+    }
+    return f.error()==QFile::NoError;
+}
+
+bool SolutionStore::exportJSONLines(const QString& fileName) const
+{
+    QFile f(fileName);
+    if (!f.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+    for (int n=0; n<size(); n++) {
+        QByteArray line = "[";
+        for (int v=0; v<_nVis; v++) {
+            QByteArray data = record(n*_nVis+v).trimmed();
+            // Line breaks can only occur as whitespace in valid JSON
+            data.replace('\n', ' ');
+            data.replace('\r', ' ');
+            if (v > 0)
+                line += ",";
+            line += data.isEmpty() ? QByteArray("null") : data;
+        }
+        line += "]\n";
+        f.write(line);
+    }
+    return f.error()==QFile::NoError;
+}
@@ -0,0 +1,52 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SOLUTIONSTORE_H
+#define SOLUTIONSTORE_H
+
+#include <QStringList>
+#include <QTemporaryFile>
+#include <QVector>
+
+/// Append-only store for the JSON solutions of a run.
+///
+/// Each solution consists of one JSON string per visualisation. The data
+/// is written to a temporary file as it arrives and only an index of
+/// record offsets is kept in memory; records are read back through a
+/// memory mapping of the file. The file grows in steps that double its
+/// size, and the whole of it is mapped, so that reading during a run
+/// only has to map the file again when it has doubled.
+class SolutionStore
+{
+public:
+    explicit SolutionStore(int nVis);
+    ~SolutionStore(void);
+
+    /// Append a solution with one JSON string per visualisation
+    bool append(const QStringList& data);
+    /// Number of solutions in the store
+    int size(void) const;
+    int nVis(void) const { return _nVis; }
+    /// The JSON of solution \a n for visualisation \a vis
+    QString get(int n, int vis) const;
+
+    /// Write all solutions as CSV with columns solution, visualisation and data
+    bool exportCSV(const QString& fileName) const;
+    /// Write all solutions as JSON Lines, one array of visualisation data per solution
+    bool exportJSONLines(const QString& fileName) const;
+private:
+    int _nVis;
+    mutable QTemporaryFile _file;
+    QVector<qint64> _offsets;
+    qint64 _end;
+    /// Size of the file, of which the records take up the first _end bytes
+    qint64 _capacity;
+    mutable uchar* _map;
+    mutable qint64 _mapped;
+    QByteArray record(int k) const;
+    SolutionStore(const SolutionStore&);
+    SolutionStore& operator =(const SolutionStore&);
+};
+
+#endif // SOLUTIONSTORE_H
@@ -16,11 +16,20 @@
 #include <QDebug>
 #include <QMessageBox>
 #include <QFileDialog>
-#include <QSettings>
+#include "settings.h"
+#include "trace.h"
 #include <QProcess>
 
 #include <QtGlobal>
 #ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+#ifdef Q_OS_WIN
 #define pathSep ";"
 #define fileDialogSuffix "/"
 #define MZNOS "win"
@@ -53,12 +62,10 @@ SolverDialog::SolverDialog(QVector<Solver>& solvers0, const QString& def,
     defaultSolver = ui->solvers_combo->findText(def);
     ui->solver_default->setChecked(0==defaultSolver);
     ui->solver_default->setEnabled(0!=defaultSolver);
-    QSettings settings;
-    settings.beginGroup("ide");
-    ui->check_updates->setChecked(settings.value("checkforupdates",false).toBool());
-    ui->send_stats->setChecked(settings.value("sendstats",false).toBool());
+    Settings* settings = Settings::instance();
+    ui->check_updates->setChecked(settings->value("ide/checkforupdates",false).toBool());
+    ui->send_stats->setChecked(settings->value("ide/sendstats",false).toBool());
     ui->send_stats->setEnabled(ui->check_updates->isChecked());
-    settings.endGroup();
     if (openAsAddNew)
         ui->solvers_combo->setCurrentIndex(ui->solvers_combo->count()-1);
     editingFinished(false);
@@ -169,25 +176,20 @@ void SolverDialog::on_solver_default_stateChanged(int state)
 
 void SolverDialog::on_check_updates_stateChanged(int checkstate)
 {
-    QSettings settings;
-    settings.beginGroup("ide");
-    settings.setValue("checkforupdates", checkstate==Qt::Checked);
-    settings.endGroup();
+    Settings::instance()->setValue("ide/checkforupdates", checkstate==Qt::Checked);
     ui->send_stats->setEnabled(checkstate==Qt::Checked);
 }
 
 void SolverDialog::on_send_stats_stateChanged(int checkstate)
 {
-    QSettings settings;
-    settings.beginGroup("ide");
-    settings.setValue("sendstats", checkstate==Qt::Checked);
-    settings.endGroup();
+    Settings::instance()->setValue("ide/sendstats", checkstate==Qt::Checked);
 }
 
 void SolverDialog::checkMzn2fznExecutable(const QString& mznDistribPath,
                                           QString& mzn2fzn_executable,
                                           QString& mzn2fzn_version_string)
 {
+    TRACE_SPAN("SolverDialog::checkMzn2fznExecutable");
     MznProcess p;
     QStringList args;
     args << "--version";
@@ -232,8 +234,26 @@ void SolverDialog::on_mznDistribPath_editingFinished()
     editingFinished(true);
 }
 
+MznProcess::MznProcess(QObject* parent)
+    : QProcess(parent), _memoryLimit(0), _traceStart(-1), _pgid(0), _stopPhase(0)
+{
+    connect(this, SIGNAL(finished(int)), this, SLOT(traceFinished()));
+    _stopTimer = new QTimer(this);
+    _stopTimer->setSingleShot(true);
+    connect(_stopTimer, SIGNAL(timeout()), this, SLOT(escalateStop()));
+}
+
+MznProcess::~MznProcess(void)
+{
+    // Only kill the group while we know it still belongs to us: once the
+    // leader has been reaped and stopping is over, the id may be reused
+    if (state() != QProcess::NotRunning || _stopPhase != 0)
+        killGroup();
+}
+
 void MznProcess::start(const QString &program, const QStringList &arguments, const QString &path)
 {
+    TRACE_SPAN("MznProcess::start");
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
     QString curPath = env.value("PATH");
     QString addPath = IDE::instance()->appDir();
@@ -247,9 +267,132 @@ void MznProcess::start(const QString &program, const QStringList &arguments, con
     setenv("PATH", (addPath + pathSep + curPath).toStdString().c_str(), 1);
 #endif
     QProcess::start(program,arguments);
+    _traceStart = Trace::isEnabled() ? Trace::now() : -1;
 #ifdef Q_OS_WIN
     _putenv_s("PATH", curPath.toStdString().c_str());
 #else
     setenv("PATH", curPath.toStdString().c_str(), 1);
+    _pgid = pid();
+    // Also set the process group from the parent, so that signals sent
+    // right after starting cannot miss the group (fails harmlessly if the
+    // child has already done it itself)
+    if (_pgid > 0)
+        setpgid(_pgid, _pgid);
+#endif
+}
+
+void MznProcess::traceFinished(void)
+{
+    // Every compiler, solver and checker process, from start to exit
+    if (_traceStart >= 0)
+        Trace::record("MznProcess::run", _traceStart, Trace::now());
+    _traceStart = -1;
+}
+
+void MznProcess::signalGroup(int sig)
+{
+#ifdef Q_OS_WIN
+    Q_UNUSED(sig);
+#else
+    // Never signal group 0, that would be the IDE's own process group
+    if (_pgid > 0) {
+        if (::kill(-_pgid, sig) == -1 && state() != QProcess::NotRunning)
+            ::kill(_pgid, sig);
+    }
+#endif
+}
+
+bool MznProcess::groupAlive(void) const
+{
+#ifdef Q_OS_WIN
+    return state() != QProcess::NotRunning;
+#else
+    if (_pgid <= 0)
+        return false;
+    return ::kill(-_pgid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+void MznProcess::interrupt(void)
+{
+#ifdef Q_OS_WIN
+    AttachConsole(pid()->dwProcessId);
+    SetConsoleCtrlHandler(NULL, TRUE);
+    GenerateConsoleCtrlEvent(CTRL_C_EVENT, 0);
+#else
+    signalGroup(SIGINT);
+#endif
+}
+
+void MznProcess::killGroup(void)
+{
+#ifndef Q_OS_WIN
+    signalGroup(SIGKILL);
 #endif
+    if (state() != QProcess::NotRunning)
+        kill();
+}
+
+void MznProcess::stop(void)
+{
+    if (_stopPhase != 0)
+        return;
+    connect(this, SIGNAL(finished(int)), this, SLOT(stopFinished()));
+    _stopPhase = 1;
+    interrupt();
+    _stopTimer->start(1000);
 }
+
+void MznProcess::escalateStop(void)
+{
+    if (!groupAlive()) {
+        stopFinished();
+        return;
+    }
+    switch (_stopPhase) {
+    case 1:
+#ifdef Q_OS_WIN
+        kill();
+#else
+        signalGroup(SIGTERM);
+#endif
+        _stopPhase = 2;
+        _stopTimer->start(1000);
+        break;
+    case 2:
+        killGroup();
+        _stopPhase = 3;
+        _stopTimer->start(500);
+        break;
+    default:
+        // Processes that survive SIGKILL are stuck in the kernel, give up
+        _stopPhase = 0;
+        emit stopped(false);
+        break;
+    }
+}
+
+void MznProcess::stopFinished(void)
+{
+    if (_stopPhase == 0 || groupAlive())
+        return;
+    _stopPhase = 0;
+    _stopTimer->stop();
+    emit stopped(true);
+}
+
+#ifndef Q_OS_WIN
+void MznProcess::setupChildProcess()
+{
+    // Runs in the child between fork and exec, so only async-signal-safe calls here.
+    // Put the solver into its own process group so that it can be stopped
+    // together with all the processes it spawns.
+    setpgid(0, 0);
+    if (_memoryLimit > 0) {
+        struct rlimit rl;
+        rl.rlim_cur = static_cast<rlim_t>(_memoryLimit)*1024*1024;
+        rl.rlim_max = rl.rlim_cur;
+        setrlimit(RLIMIT_AS, &rl);
+    }
+}
+#endif
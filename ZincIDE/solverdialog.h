@@ -15,6 +15,7 @@
 
 #include <QDialog>
 #include <QProcess>
+#include <QTimer>
 
 namespace Ui {
 class SolverDialog;
@@ -33,9 +34,43 @@ struct Solver {
 };
 
 class MznProcess : public QProcess {
+    Q_OBJECT
 public:
-    MznProcess(QObject* parent=NULL) : QProcess(parent) {}
+    MznProcess(QObject* parent=NULL);
+    ~MznProcess(void);
     void start(const QString& program, const QStringList& arguments, const QString& path);
+    /// Limit the address space of the process (in megabytes, 0 means no limit).
+    /// The limit is inherited by all processes the solver spawns.
+    void setMemoryLimit(int mb) { _memoryLimit = mb; }
+    int memoryLimit(void) const { return _memoryLimit; }
+    /// Send an interrupt (SIGINT or CTRL-C) to the process and all its descendants
+    void interrupt(void);
+    /// Kill the process and all its descendants immediately
+    void killGroup(void);
+    /// Stop the process and all its descendants without blocking, escalating
+    /// from SIGINT to SIGTERM to SIGKILL. Emits stopped() when done.
+    void stop(void);
+    /// Whether any process of the process group is still running
+    bool groupAlive(void) const;
+signals:
+    /// Emitted when stop() has finished; \a clean is false if some
+    /// descendant process could not be stopped
+    void stopped(bool clean);
+private slots:
+    void escalateStop(void);
+    void stopFinished(void);
+    void traceFinished(void);
+protected:
+    int _memoryLimit;
+    /// When the process was started, if a performance trace is recorded (else -1)
+    qint64 _traceStart;
+    qint64 _pgid;
+    int _stopPhase;
+    QTimer* _stopTimer;
+    void signalGroup(int sig);
+#ifndef Q_OS_WIN
+    virtual void setupChildProcess();
+#endif
 };
 
 class SolverDialog : public QDialog
@@ -0,0 +1,102 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "tokenizer.h"
+
+#include <QSet>
+
+namespace {
+    QSet<QString> makeKeywords(void)
+    {
+        static const char* const keywords[] = {
+            "ann", "annotation", "any", "array", "bool", "case",
+            "constraint", "default", "div", "diff", "else", "elseif",
+            "endif", "enum", "float", "function", "if", "include",
+            "intersect", "in", "int", "let", "maximize", "minimize",
+            "mod", "not", "of", "output", "opt", "par", "predicate",
+            "record", "satisfy", "set", "solve", "string", "subset",
+            "superset", "symdiff", "test", "then", "tuple", "type",
+            "union", "var", "variant_record", "where", "xor"
+        };
+        QSet<QString> ret;
+        for (unsigned int i=0; i<sizeof(keywords)/sizeof(keywords[0]); i++)
+            ret.insert(keywords[i]);
+        return ret;
+    }
+
+    // Initialised before main, so that tokenizing is safe from any thread
+    const QSet<QString> keywords = makeKeywords();
+}
+
+bool Tokenizer::isKeyword(const QString& word)
+{
+    return keywords.contains(word);
+}
+
+QStringList Tokenizer::keywords(void)
+{
+    return ::keywords.toList();
+}
+
+bool Tokenizer::tokenize(const QString& line, bool inComment, QVector<Token>& tokens)
+{
+    const int n = line.size();
+    const QChar* s = line.constData();
+    int i = 0;
+    if (inComment) {
+        int end = line.indexOf("*/");
+        if (end == -1) {
+            tokens.append(Token(0, n, Comment));
+            return true;
+        }
+        tokens.append(Token(0, end+2, Comment));
+        i = end+2;
+    }
+    while (i < n) {
+        QChar c = s[i];
+        if (c == '"') {
+            // Strings run until the next unescaped quote; an unterminated
+            // quote is not highlighted
+            int j = i+1;
+            while (j < n && s[j] != '"') {
+                if (s[j] == '\\')
+                    j++;
+                j++;
+            }
+            if (j < n) {
+                tokens.append(Token(i, j+1-i, String));
+                i = j+1;
+            } else {
+                i++;
+            }
+        } else if (c == '%') {
+            tokens.append(Token(i, n-i, Comment));
+            return false;
+        } else if (c == '/' && i+1 < n && s[i+1] == '*') {
+            int end = line.indexOf("*/", i+2);
+            if (end == -1) {
+                tokens.append(Token(i, n-i, Comment));
+                return true;
+            }
+            tokens.append(Token(i, end+2-i, Comment));
+            i = end+2;
+        } else if (isWordChar(c)) {
+            int j = i+1;
+            while (j < n && isWordChar(s[j]))
+                j++;
+            int k = j;
+            while (k < n && s[k].isSpace())
+                k++;
+            if (k < n && s[k] == '(') {
+                tokens.append(Token(i, j-i, Function));
+            } else if (isKeyword(QString::fromRawData(s+i, j-i))) {
+                tokens.append(Token(i, j-i, Keyword));
+            }
+            i = j;
+        } else {
+            i++;
+        }
+    }
+    return false;
+}
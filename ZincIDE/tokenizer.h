@@ -0,0 +1,40 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// Splits lines of Zinc code into the token classes used for syntax
+/// highlighting. The tokenizer does not depend on a QTextDocument or its
+/// layouts, so it can also be used on plain text in other threads.
+class Tokenizer
+{
+public:
+    enum TokenClass { Plain=0, String, Comment, Keyword, Function, NumClasses };
+    struct Token {
+        int start;
+        int length;
+        TokenClass cls;
+        Token(int s=0, int l=0, TokenClass c=Plain) : start(s), length(l), cls(c) {}
+    };
+    /// Append the tokens of \a line to \a tokens (only non-plain tokens are
+    /// reported). \a inComment is whether the line starts inside a block
+    /// comment. Returns whether the line ends inside a block comment.
+    static bool tokenize(const QString& line, bool inComment, QVector<Token>& tokens);
+    static bool isKeyword(const QString& word);
+    /// Whether \a c can be part of an identifier
+    static bool isWordChar(QChar c)
+    {
+        ushort u = c.unicode();
+        return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') ||
+               (u >= '0' && u <= '9') || u == '_';
+    }
+    static QStringList keywords(void);
+};
+
+#endif // TOKENIZER_H
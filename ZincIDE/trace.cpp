@@ -0,0 +1,173 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QThreadStorage>
+
+QAtomicInt Trace::_enabled(0);
+QAtomicInt Trace::_generation(0);
+
+/// Spans kept per thread, a power of two
+static const int bufferSize = 1 << 14;
+
+namespace {
+    struct Event {
+        const char* name;
+        qint64 start;
+        qint64 end;
+        int thread;
+    };
+
+    /// Written by one thread at a time. written counts the events up to
+    /// twice the buffer size, so that a full buffer can be told apart
+    /// from an empty one. Only the owning thread empties its buffer, when
+    /// it sees that generation is behind Trace::_generation.
+    struct Buffer {
+        Event events[bufferSize];
+        QAtomicInt written;
+        QAtomicInt generation;
+        QAtomicInt inUse;
+        int thread;
+    };
+
+    /// Returns the buffer to the pool when its thread exits
+    struct BufferHolder {
+        Buffer* buffer;
+        BufferHolder(Buffer* b) : buffer(b) {}
+        ~BufferHolder(void) { buffer->inUse.store(0); }
+    };
+
+    struct Clock {
+        QElapsedTimer timer;
+        Clock(void) { timer.start(); }
+    };
+
+    Clock traceClock;
+    QMutex buffersMutex;
+    QList<Buffer*> buffers;
+    QHash<int,QString> threadNames;
+    int threadCount = 0;
+    QThreadStorage<BufferHolder*> threadBuffer;
+
+    /// The buffer of the current thread, taken from the pool (or created)
+    /// the first time the thread records a span
+    Buffer* currentBuffer(void)
+    {
+        if (threadBuffer.hasLocalData())
+            return threadBuffer.localData()->buffer;
+        QMutexLocker lock(&buffersMutex);
+        Buffer* b = NULL;
+        for (int i=0; i<buffers.size(); i++) {
+            if (buffers[i]->inUse.testAndSetOrdered(0, 1)) {
+                b = buffers[i];
+                break;
+            }
+        }
+        if (b==NULL) {
+            b = new Buffer;
+            b->written.store(0);
+            b->generation.store(-1);
+            b->inUse.store(1);
+            buffers.append(b);
+        }
+        b->thread = threadCount++;
+        QThread* t = QThread::currentThread();
+        QString name = t->objectName();
+        if (name.isEmpty())
+            name = t==QCoreApplication::instance()->thread() ? "GUI" : t->metaObject()->className();
+        threadNames.insert(b->thread, name);
+        threadBuffer.setLocalData(new BufferHolder(b));
+        return b;
+    }
+}
+
+void Trace::setEnabled(bool enable)
+{
+    // The buffers are emptied by their own threads when they next record,
+    // as other threads may be writing to them right now
+    if (enable)
+        _generation.ref();
+    _enabled.store(enable ? 1 : 0);
+}
+
+qint64 Trace::now(void)
+{
+    return traceClock.timer.nsecsElapsed();
+}
+
+void Trace::record(const char* name, qint64 start, qint64 end)
+{
+    Buffer* b = currentBuffer();
+    int generation = _generation.loadAcquire();
+    if (b->generation.load() != generation) {
+        b->written.store(0);
+        b->generation.storeRelease(generation);
+    }
+    int n = b->written.load();
+    Event& e = b->events[n & (bufferSize-1)];
+    e.name = name;
+    e.start = start;
+    e.end = end;
+    e.thread = b->thread;
+    b->written.storeRelease(n+1 == 2*bufferSize ? bufferSize : n+1);
+}
+
+bool Trace::save(const QString& fileName)
+{
+    QJsonArray events;
+    int pid = int(QCoreApplication::applicationPid());
+    QMutexLocker lock(&buffersMutex);
+    for (QHash<int,QString>::const_iterator it = threadNames.begin(); it != threadNames.end(); ++it) {
+        QJsonObject args;
+        args["name"] = it.value();
+        QJsonObject meta;
+        meta["name"] = QString("thread_name");
+        meta["ph"] = QString("M");
+        meta["pid"] = pid;
+        meta["tid"] = it.key();
+        meta["args"] = args;
+        events.append(meta);
+    }
+    int generation = _generation.loadAcquire();
+    for (int i=0; i<buffers.size(); i++) {
+        // Spans from before recording was last started are discarded
+        if (buffers[i]->generation.loadAcquire() != generation)
+            continue;
+        // Oldest first; spans recorded while saving may be overwritten
+        int n = buffers[i]->written.loadAcquire();
+        int first = n < bufferSize ? 0 : n;
+        int count = n < bufferSize ? n : bufferSize;
+        for (int j=0; j<count; j++) {
+            const Event& e = buffers[i]->events[(first+j) & (bufferSize-1)];
+            QJsonObject o;
+            o["name"] = QString(e.name);
+            o["cat"] = QString("ide");
+            o["ph"] = QString("X");
+            o["ts"] = e.start/1000.0;
+            o["dur"] = (e.end-e.start)/1000.0;
+            o["pid"] = pid;
+            o["tid"] = e.thread;
+            events.append(o);
+        }
+    }
+    lock.unlock();
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = QString("ms");
+    QFile f(fileName);
+    if (!f.open(QFile::WriteOnly))
+        return false;
+    return f.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) != -1;
+}
@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QAtomicInt>
+#include <QString>
+
+/// Performance traces of the IDE in the Chrome trace event format, which
+/// chrome://tracing and ui.perfetto.dev can display.
+///
+/// Code is instrumented with TRACE_SPAN, which records the time spent in
+/// the enclosing scope while recording is enabled. A disabled span costs
+/// a single atomic load. Each thread records into a ring buffer of its
+/// own, so recording takes no locks; only the most recent spans of each
+/// thread are kept.
+class Trace
+{
+public:
+    static bool isEnabled(void) { return _enabled.load() != 0; }
+    /// Start recording (discarding earlier spans) or stop recording
+    static void setEnabled(bool enable);
+    /// Nanoseconds since the start of the IDE
+    static qint64 now(void);
+    /// Record a span of the current thread
+    static void record(const char* name, qint64 start, qint64 end);
+    /// Write the recorded spans as trace event JSON to \a fileName
+    static bool save(const QString& fileName);
+private:
+    static QAtomicInt _enabled;
+    /// Incremented whenever recording starts, to empty the buffers
+    static QAtomicInt _generation;
+};
+
+/// Records the lifetime of the object as a span called \a name, which
+/// must be a string literal
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name)
+        : _name(name), _start(Trace::isEnabled() ? Trace::now() : -1) {}
+    ~TraceSpan(void) {
+        if (_start >= 0)
+            Trace::record(_name, _start, Trace::now());
+    }
+private:
+    const char* _name;
+    qint64 _start;
+};
+
+#define TRACE_CONCAT2(a,b) a##b
+#define TRACE_CONCAT(a,b) TRACE_CONCAT2(a,b)
+/// Trace the rest of the enclosing scope
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan,__LINE__)(name)
+
+#endif // TRACE_H
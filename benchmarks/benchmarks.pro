@@ -0,0 +1,23 @@
+# Microbenchmarks of the editor hot paths, see README.txt
+
+QT       += testlib
+
+TARGET = zincide-benchmarks
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../ZincIDE/ZincIDE.pri)
+
+SOURCES += \
+    fixtures.cpp \
+    tst_editorbenchmarks.cpp
+
+HEADERS += \
+    fixtures.h
+
+# make benchmark: run all benchmarks and write the results to
+# benchmark-results.xml for compare_benchmarks.py
+benchmark.commands = ./$$TARGET -o benchmark-results.xml,xml
+benchmark.depends = $$TARGET
+QMAKE_EXTRA_TARGETS += benchmark
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+"""Compare two benchmark result files written with -o FILE,xml.
+
+Prints the change of every benchmark and exits with status 1 if any
+benchmark got slower by more than the threshold.
+"""
+
+import argparse
+import sys
+import xml.etree.ElementTree as ET
+
+
+def load(path):
+    results = {}
+    root = ET.parse(path).getroot()
+    for function in root.iter("TestFunction"):
+        for result in function.iter("BenchmarkResult"):
+            key = function.get("name")
+            if result.get("tag"):
+                key += ":" + result.get("tag")
+            value = float(result.get("value")) / max(1, int(result.get("iterations", "1")))
+            results[key] = (value, result.get("metric"))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="slowdown in percent reported as a regression (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+    print("%-45s %14s %14s %9s" % ("benchmark", "baseline", "current", "change"))
+    for key in sorted(set(baseline) | set(current)):
+        if key not in baseline or key not in current:
+            print("%-45s %s" % (key, "only in " + ("current" if key in current else "baseline")))
+            continue
+        (old, metric), (new, _) = baseline[key], current[key]
+        change = (new - old) / old * 100 if old > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-45s %14.4f %14.4f %+8.1f%%%s" % (key, old, new, change, flag))
+    print("(values per iteration, metric %s)" % next(iter(current.values()), (0, "?"))[1])
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
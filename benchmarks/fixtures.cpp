@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "fixtures.h"
+
+#include <QFile>
+
+namespace {
+    /// Linear congruential generator, so fixtures do not depend on the
+    /// platform's rand()
+    class Random {
+    public:
+        explicit Random(quint32 seed) : _state(seed) {}
+        int next(int n) {
+            _state = _state*1664525u + 1013904223u;
+            return int((_state >> 8) % quint32(n));
+        }
+    private:
+        quint32 _state;
+    };
+
+    QString num(int i)
+    {
+        return QString().number(i);
+    }
+}
+
+QString Fixtures::syntheticModel(int lines)
+{
+    Random r(42);
+    QStringList result;
+    for (int i=0; i<lines; i++) {
+        QString v = "x"+num(r.next(100));
+        QString w = "y"+num(r.next(100));
+        switch (r.next(8)) {
+        case 0:
+            result << "int: n"+num(i)+" = "+num(r.next(1000))+";";
+            break;
+        case 1:
+            result << "array[1..n] of var 0.."+num(r.next(100))+": "+v+";   % decision variables";
+            break;
+        case 2:
+            result << "constraint forall (i in 1..n) ("+v+"[i] <= "+w+"[i] + "+num(r.next(10))+");";
+            break;
+        case 3:
+            result << "constraint sum (j in index_set("+v+")) (bool2int("+v+"[j] > "+w+"[j])) >= 1;";
+            break;
+        case 4:
+            result << "output [\""+v+" = \\("+v+")\\n\", \"done\"];";
+            break;
+        case 5:
+            result << "/* "+v+" and "+w+" are symmetric */";
+            break;
+        case 6:
+            result << "predicate p"+num(i)+"(var int: a, var int: b) = a < b \\/ (a = b /\\ "+v+"[1] > 0);";
+            break;
+        default:
+            if (r.next(50)==0) {
+                QStringList values;
+                for (int j=0; j<500; j++)
+                    values << num(r.next(10000));
+                result << "d"+num(i)+" = ["+values.join(", ")+"];";
+            } else {
+                result << "";
+            }
+        }
+    }
+    return result.join("\n");
+}
+
+QString Fixtures::realModel(int lines)
+{
+    QFile f(":/cheat_sheet.mzn");
+    if (!f.open(QFile::ReadOnly))
+        return QString();
+    QString model = QString::fromUtf8(f.readAll());
+    int modelLines = model.count('\n')+1;
+    QString result;
+    for (int n=0; n < lines; n += modelLines)
+        result += model+"\n";
+    return result;
+}
+
+QString Fixtures::nestedBrackets(int depth)
+{
+    static const char* open = "([{";
+    static const char* close = ")]}";
+    QStringList result;
+    result << "constraint";
+    for (int i=0; i<depth; i++)
+        result << QString(i%40, ' ')+"f"+num(i)+QChar(open[i%3])+"a"+num(i)+", ";
+    result << "x";
+    for (int i=depth; i--;)
+        result << QString(i%40, ' ')+QChar(close[i%3]);
+    result << ";";
+    return result.join("\n");
+}
+
+QStringList Fixtures::solutions(int n)
+{
+    Random r(7);
+    QStringList result;
+    for (int i=0; i<n; i++) {
+        QStringList values;
+        for (int j=0; j<100; j++)
+            values << num(r.next(1000));
+        result << "{\n  \"x\": ["+values.join(", ")+"],\n"
+                  "  \"name\": \"solution "+num(i)+"\",\n"
+                  "  \"note\": \"it's \\\"quoted\\\"\"\n}";
+    }
+    return result;
+}
+
+QStringList Fixtures::projectFiles(int n)
+{
+    QStringList result;
+    for (int i=0; i<n; i++) {
+        QString dir = "/benchmark/project/dir"+num(i%20)+"/sub"+num((i/20)%10)+"/";
+        result << dir+(i%4==0 ? "data"+num(i)+".dzn" : "model"+num(i)+".zinc");
+    }
+    return result;
+}
@@ -0,0 +1,27 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include <QStringList>
+
+/// Inputs for the benchmarks. They are generated with a fixed seed, so
+/// every build benchmarks exactly the same inputs and results can be
+/// compared across commits.
+namespace Fixtures {
+    /// A model of \a lines lines mixing declarations, constraints, output
+    /// items, comments, strings and the occasional long data line
+    QString syntheticModel(int lines);
+    /// The cheat sheet model repeated to at least \a lines lines
+    QString realModel(int lines);
+    /// A constraint with \a depth nested brackets, one level per line
+    QString nestedBrackets(int depth);
+    /// \a n solutions in the JSON format of the solution store
+    QStringList solutions(int n);
+    /// \a n distinct model and data file names spread over nested directories
+    QStringList projectFiles(int n);
+}
+
+#endif // FIXTURES_H
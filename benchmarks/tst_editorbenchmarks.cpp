@@ -0,0 +1,201 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QMimeData>
+#include <QPlainTextDocumentLayout>
+#include <QSortFilterProxyModel>
+#include <QTreeView>
+
+#include "codeeditor.h"
+#include "finddialog.h"
+#include "highlighter.h"
+#include "htmlpage.h"
+#include "project.h"
+#include "rtfexporter.h"
+#include "fixtures.h"
+
+/// Benchmarks of the code paths that run while editing, running models
+/// and managing projects
+class EditorBenchmarks : public QObject
+{
+    Q_OBJECT
+private slots:
+    void highlightBlock_data(void);
+    void highlightBlock(void);
+    void matchBrackets_data(void);
+    void matchBrackets(void);
+    void replaceAll_data(void);
+    void replaceAll(void);
+    void escapeSolutions_data(void);
+    void escapeSolutions(void);
+    void projectAddFile_data(void);
+    void projectAddFile(void);
+    void exportHighlighted_data(void);
+    void exportHighlighted(void);
+};
+
+namespace {
+    void addModels(void)
+    {
+        QTest::addColumn<QString>("text");
+        QTest::newRow("synthetic-1k") << Fixtures::syntheticModel(1000);
+        QTest::newRow("synthetic-10k") << Fixtures::syntheticModel(10000);
+        QTest::newRow("real-1k") << Fixtures::realModel(1000);
+        QTest::newRow("real-10k") << Fixtures::realModel(10000);
+    }
+
+    void setDocument(QTextDocument& doc, const QString& text)
+    {
+        doc.setDocumentLayout(new QPlainTextDocumentLayout(&doc));
+        doc.setPlainText(text);
+    }
+}
+
+void EditorBenchmarks::highlightBlock_data(void)
+{
+    addModels();
+}
+
+void EditorBenchmarks::highlightBlock(void)
+{
+    QFETCH(QString, text);
+    QTextDocument doc;
+    setDocument(doc, text);
+    Highlighter* h = Highlighter::forDocument(&doc, false);
+    // Every block is highlighted through highlightBlock
+    QBENCHMARK {
+        h->rehighlight();
+    }
+}
+
+void EditorBenchmarks::matchBrackets_data(void)
+{
+    QTest::addColumn<int>("depth");
+    QTest::newRow("depth-100") << 100;
+    QTest::newRow("depth-1000") << 1000;
+    QTest::newRow("depth-10000") << 10000;
+}
+
+void EditorBenchmarks::matchBrackets(void)
+{
+    QFETCH(int, depth);
+    QFont font;
+    CodeEditor ce(NULL, "benchmark.zinc", true, false, font, false, NULL, NULL);
+    ce.document()->setPlainText(Fixtures::nestedBrackets(depth));
+    QString text = ce.document()->toPlainText();
+    // Right after the outermost opening bracket matchLeft searches
+    // forward, right after the outermost closing bracket matchRight
+    // searches backward
+    int open = text.indexOf('(')+1;
+    int close = text.lastIndexOf(')')+1;
+    QTextCursor cursor(ce.document());
+    QBENCHMARK {
+        cursor.setPosition(open);
+        ce.setTextCursor(cursor);
+        cursor.setPosition(close);
+        ce.setTextCursor(cursor);
+    }
+}
+
+void EditorBenchmarks::replaceAll_data(void)
+{
+    QTest::addColumn<int>("lines");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+}
+
+void EditorBenchmarks::replaceAll(void)
+{
+    QFETCH(int, lines);
+    QFont font;
+    CodeEditor ce(NULL, "benchmark.zinc", true, false, font, false, NULL, NULL);
+    ce.document()->setPlainText(Fixtures::syntheticModel(lines));
+    FindDialog fd;
+    fd.setEditor(&ce);
+    QLineEdit* find = fd.findChild<QLineEdit*>("find");
+    QLineEdit* replace = fd.findChild<QLineEdit*>("replace");
+    QVERIFY(find && replace);
+    fd.findChild<QCheckBox*>("check_case")->setChecked(false);
+    fd.findChild<QCheckBox*>("check_wrap")->setChecked(false);
+    fd.findChild<QCheckBox*>("check_re")->setChecked(false);
+    // Alternate between replacing and restoring the word, so every
+    // iteration does the same amount of work
+    bool forward = true;
+    QBENCHMARK {
+        find->setText(forward ? "constraint" : "CONSTRAINT");
+        replace->setText(forward ? "CONSTRAINT" : "constraint");
+        ce.setTextCursor(QTextCursor(ce.document()));
+        fd.on_b_replaceall_clicked();
+        forward = !forward;
+    }
+}
+
+void EditorBenchmarks::escapeSolutions_data(void)
+{
+    QTest::addColumn<int>("solutions");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+}
+
+void EditorBenchmarks::escapeSolutions(void)
+{
+    QFETCH(int, solutions);
+    QStringList json = Fixtures::solutions(solutions);
+    int size = 0;
+    QBENCHMARK {
+        for (int i=0; i<json.size(); i++)
+            size += HTMLPage::escapeSolution(json[i]).size();
+    }
+    QVERIFY(size > 0);
+}
+
+void EditorBenchmarks::projectAddFile_data(void)
+{
+    QTest::addColumn<int>("files");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+}
+
+void EditorBenchmarks::projectAddFile(void)
+{
+    QFETCH(int, files);
+    QStringList names = Fixtures::projectFiles(files);
+    QBENCHMARK {
+        Project project(NULL);
+        QSortFilterProxyModel sort;
+        sort.setSourceModel(&project);
+        QTreeView view;
+        view.setModel(&sort);
+        for (int i=0; i<names.size(); i++)
+            project.addFile(&view, &sort, names[i]);
+    }
+}
+
+void EditorBenchmarks::exportHighlighted_data(void)
+{
+    addModels();
+}
+
+void EditorBenchmarks::exportHighlighted(void)
+{
+    QFETCH(QString, text);
+    QTextDocument doc;
+    setDocument(doc, text);
+    Highlighter* h = Highlighter::forDocument(&doc, false);
+    h->rehighlight();
+    // What Copy puts on the clipboard, without the clipboard itself, whose
+    // cost depends on the platform and on other applications
+    QBENCHMARK {
+        RtfExporter exporter(doc.defaultFont());
+        exporter.exportRange(&doc, 0, doc.characterCount()-1);
+        delete exporter.mimeData();
+    }
+}
+
+QTEST_MAIN(EditorBenchmarks)
+
+#include "tst_editorbenchmarks.moc"